@@ -6,6 +6,9 @@
 #include <cstring>
 #include <cmath>
 #include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <ncurses.h>
 #include <string>
 #include <vector>
@@ -15,6 +18,21 @@
 #include <limits>
 #include <algorithm>
 #include <functional>
+#include <chrono>
+#include <numeric>
+#include <type_traits>
+#include <cassert>
+#include <string_view>
+#include <charconv>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <future>
+#include <queue>
+#include <memory>
+#include <memory_resource>
+#include <deque>
+#include <cstdint>
 
 // Board Size
 #define WIDTH 80
@@ -22,6 +40,10 @@
 #define MAP_SIZE 401
 #define MAP_CENTER 200
 
+// Sparse world index: maps are grouped into CHUNK_SIZE x CHUNK_SIZE chunks allocated on first use
+#define CHUNK_SIZE 16
+#define NUM_CHUNKS ((MAP_SIZE + CHUNK_SIZE - 1) / CHUNK_SIZE)
+
 // Terrain types
 #define BORDER '%'
 #define GRASS '.'
@@ -41,6 +63,33 @@
 #define SENTRY 's'
 #define EXPLORER 'e'
 
+// Movement-cost layers cached per map, one per distinct get_movement_cost behavior
+#define COST_PC 0
+#define COST_HIKER 1
+#define COST_RIVAL 2
+#define COST_OTHER 3
+#define NUM_COST_LAYERS 4
+
+// Trainer types that path toward the PC; each gets a plane in DistanceMaps (see pathing_types)
+#define NUM_PATHING_TYPES 2
+
+// Special values of map::occupant; trainers are stored by their index in map::npcs
+#define NO_OCCUPANT -1
+#define PC_OCCUPANT -2
+#define PC_ACTING -2 // TurnQueue::pcSeq while the PC is taking its turn
+
+// Slots of BaseStats::stat, in stats.csv order (stat id - 1)
+#define STAT_HP 0
+#define STAT_ATTACK 1
+#define STAT_DEFENSE 2
+#define STAT_SPECIAL_ATTACK 3
+#define STAT_SPECIAL_DEFENSE 4
+#define STAT_SPEED 5
+#define NUM_STATS 6
+
+// Elemental types with effectiveness data; type ids 1 to NUM_TYPES (normal to fairy)
+#define NUM_TYPES 18
+
 // Region generation parameters
 #define MIN_RADIUS 2
 #define MAX_RADIUS 5
@@ -61,88 +110,178 @@ int curPokeIndex = 0;
 int attemps = 0;
 bool battleContinues = true;
 
+// Independent random streams, so that one subsystem drawing more or fewer numbers never shifts what
+// another one sees. With the same seed, the world, trainers and Pokemon come out the same every run.
+enum RandomStream {
+    RNG_WORLD,      // Terrain, buildings and trainer placement, rekeyed for each map (see seed_map_random)
+    RNG_TRAINERS,   // Trainers' teams, rekeyed for each map like RNG_WORLD
+    RNG_NPCS,       // Trainer movement
+    RNG_POKEMON,    // Species, levels, moves and stats of starters and wild Pokemon
+    RNG_ENCOUNTERS, // Wild encounters in tall grass
+    RNG_BATTLE,     // Hits, damage, status effects and fleeing
+    RNG_BENCH,      // Benchmark inputs
+    NUM_RANDOM_STREAMS
+};
+
+// A counter-based generator: the nth number of a stream is a hash of the stream's key and n, so a
+// stream is just two integers, needs no lock, and can be recreated from its key.
+struct RandomState {
+    uint64_t key;
+    uint64_t counter;
+};
+
+uint64_t randomSeed;
+RandomState randomStreams[NUM_RANDOM_STREAMS];
+
+// SplitMix64's finalizer, which spreads every input bit over the whole output
+uint64_t mix64(uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+// Keys every stream from seed and restarts them.
+void seed_random(uint64_t seed) {
+    randomSeed = seed;
+    for (int s = 0; s < NUM_RANDOM_STREAMS; s++) {
+        randomStreams[s] = {mix64(mix64(seed) + s), 0};
+    }
+}
+
+// Rekeys the world and trainer streams for the map at world coordinates (x, y), so each map's layout and
+// trainers depend only on the seed and where it is, not on the order maps are visited in or on what
+// happened before.
+void seed_map_random(int x, int y) {
+    uint64_t mapKey = mix64(randomSeed) + NUM_RANDOM_STREAMS + 2 * (x * MAP_SIZE + y);
+    randomStreams[RNG_WORLD] = {mix64(mapKey), 0};
+    randomStreams[RNG_TRAINERS] = {mix64(mapKey + 1), 0};
+}
+
+// Returns the next number of a stream, from 0 to 2^31 - 1 like rand().
+int next_random(RandomStream stream) {
+    RandomState &state = randomStreams[stream];
+    return (int) (mix64(state.key + ++state.counter * 0x9e3779b97f4a7c15ULL) >> 33);
+}
+
+// Pokedex rows hold only the columns the game reads. pokedexSchema lists every column of each CSV.
+// Identifiers are offsets into the identifiers string pool; see name_of.
 struct Pokemon {
     int id;
-    std::string identifier;
+    unsigned int identifier;
     int species_id;
-    int height;
-    int weight;
-    int base_experience;
-    int order;
-    bool is_default;
 };
 
+// Most moves a Pokemon can know
+#define MAX_MOVES 4
+
+// A status effect. On turn 1 the Pokemon holds the item that inflicts it and passes it to the next
+// Pokemon it attacks; from turn 2 on it suffers the effect, counting the turns it has lasted.
+enum Status : uint8_t {
+    STATUS_NONE,
+    STATUS_ASLEEP,
+    STATUS_BURNED,
+    STATUS_CONFUSED,
+    STATUS_FROZEN,
+    STATUS_PARALYZED,
+    STATUS_POISONED
+};
+
+// A Pokemon in a team, packed into 40 bytes with no pointers so teams can be copied, stored and
+// saved as plain arrays.
 struct PokemonWithMoves {
-    Pokemon pokemon;
-    std::vector<std::string> moves;
-    int level;
-    int hp;          // Hit points
-    int max_hp;      // Maximum hit points
-    int attack;      // Attack value
-    int defense;     // Defense value
-    int speed;       // Speed value
-    bool is_knocked_out; // Knock out status
-    int is_poisoned;
-    int is_paralyzed;
-    int is_burned;
-    int is_asleep;       // Tracks sleep duration
-    int is_frozen;       // Tracks freeze duration
-    int is_confused;     // Tracks confusion duration
-    int current_exp; // Current experience points
-    int next_level_exp; // Experience points needed for the next level
+    unsigned int identifier;  // Offset in the identifiers pool; see name_of
+    uint16_t pokemon_id;
+    uint16_t species_id;
+    int16_t moves[MAX_MOVES]; // Move ids; the first numMoves are known
+    uint8_t numMoves;
+    uint8_t level;
+    Status status;
+    uint8_t statusTurns;
+    uint16_t hp;              // Hit points, never below 0
+    uint16_t max_hp;          // Maximum hit points
+    uint16_t attack;          // Attack value
+    uint16_t defense;         // Defense value
+    uint16_t speed;           // Speed value
+    bool is_knocked_out;      // Knock out status
+    int current_exp;          // Current experience points
+    int next_level_exp;       // Experience points needed for the next level
+};
+static_assert(std::is_trivially_copyable<PokemonWithMoves>::value && sizeof(PokemonWithMoves) == 40,
+              "PokemonWithMoves must stay a packed plain struct");
+
+// Most Pokemon a trainer carries
+#define MAX_TEAM_SIZE 6
+
+// A trainer's team: a run of consecutive Pokemon in its map's NPCStore.
+class Team {
+public:
+    PokemonWithMoves *first;
+    int count;
+
+    PokemonWithMoves& operator[](int i) const {
+        return first[i];
+    }
+    int size() const {
+        return count;
+    }
+    PokemonWithMoves *begin() const {
+        return first;
+    }
+    PokemonWithMoves *end() const {
+        return first + count;
+    }
 };
 
 std::vector<PokemonWithMoves> pcPokemons;
 PokemonWithMoves* currentWildPokemon = nullptr;
 
+// Storage for short-lived Pokemon such as wild encounters, recycled instead of allocated for each one.
+class PokemonPool {
+public:
+    std::deque<PokemonWithMoves> slots;            // Never shrinks, so slots keep their addresses
+    std::vector<PokemonWithMoves *> freeSlots;
+};
+
+PokemonPool transientPokemons;
+
+// Returns a zeroed Pokemon from a pool, allocating only when every slot is in use.
+PokemonWithMoves *acquire_pokemon(PokemonPool *pool) {
+    PokemonWithMoves *pokemon;
+    if (pool->freeSlots.empty()) {
+        pool->slots.emplace_back();
+        pokemon = &pool->slots.back();
+    } else {
+        pokemon = pool->freeSlots.back();
+        pool->freeSlots.pop_back();
+    }
+    *pokemon = PokemonWithMoves();
+    return pokemon;
+}
+
+// Returns a Pokemon from acquire_pokemon to its pool.
+void release_pokemon(PokemonPool *pool, PokemonWithMoves *pokemon) {
+    pool->freeSlots.push_back(pokemon);
+}
+
 struct Move {
     int id;
-    std::string identifier;
-    int generation_id;
+    unsigned int identifier;
     int type_id;
     int power;
-    int pp;
     int accuracy;
-    int priority;
-    int target_id;
-    int damage_class_id;
-    int effect_id;
-    int effect_chance;
-    int contest_type_id;
-    int contest_effect_id;
-    int super_contest_effect_id;
 };
 
 struct PokemonMove {
     int pokemon_id;
-    int version_id;
     int move_id;
-    int pokemon_move_method_id;
     int level;
-    int order;
 };
 
 struct PokemonSpecies {
     int id;
-    std::string identifier;
-    int generation_id;
-    int evolves_from_species_id;
-    int evolution_chain_id;
-    int color_id;
-    int shape_id;
+    unsigned int identifier;
     int habitat_id;
-    int gender_rate;
-    int capture_rate;
-    int base_happiness;
-    bool is_baby;
-    int hatch_counter;
-    bool has_gender_differences;
     int growth_rate_id;
-    bool forms_switchable;
-    bool is_legendary;
-    bool is_mythical;
-    int order;
-    int conquest_order;
 };
 
 struct Experience {
@@ -151,133 +290,417 @@ struct Experience {
     int experience;
 };
 
+// English type names only; the other languages are skipped when type_names.csv is loaded.
 struct TypeName {
     int type_id;
-    int local_language_id;
-    std::string name;
+    unsigned int name;
 };
 
 struct PokemonStat {
     int pokemon_id;
     int stat_id;
     int base_stat;
-    int effort;
 };
 
 struct Stat {
     int id;
-    std::string identifier; // String to hold the identifier
-    int damage_class_id; // Assuming there is a damage class id
-    bool is_battle_only;
-    int game_index;
+    unsigned int identifier;
 };
 
 
+// The six base stats of one Pokemon, indexed by the STAT_* slots.
+struct BaseStats {
+    int stat[NUM_STATS];
+};
+
 struct PokemonType {
     int pokemon_id;
     int type_id;
-    int slot;
 };
 
 struct PokemonHabitat {
     int id;
-    std::string identifier;
+    unsigned int identifier;
 };
 
-std::vector<Pokemon> parsePokemonCSV(const std::string& filename) {
-    std::vector<Pokemon> pokemons;
-    std::ifstream file(filename);
-    std::string line;
-    std::getline(file, line); // Skip the header line
+// A fixed set of worker threads running queued tasks in FIFO order. The destructor finishes every
+// queued task before joining the workers.
+class ThreadPool {
+public:
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()> > tasks;
+    std::mutex lock;
+    std::condition_variable ready;
+    bool stopping;
+
+    ThreadPool(int numThreads) : stopping(false) {
+        for (int i = 0; i < numThreads; i++) {
+            workers.push_back(std::thread([this] {
+                while (true) {
+                    std::function<void()> task;
+                    {
+                        std::unique_lock<std::mutex> guard(lock);
+                        ready.wait(guard, [this] { return stopping || !tasks.empty(); });
+                        if (tasks.empty()) {
+                            return;
+                        }
+                        task = std::move(tasks.front());
+                        tasks.pop();
+                    }
+                    task();
+                }
+            }));
+        }
+    }
 
-    while (std::getline(file, line)) {
-        std::stringstream linestream(line);
-        std::string cell;
-        Pokemon pokemon;
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            stopping = true;
+        }
+        ready.notify_all();
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+    }
+};
+
+// Queues a task on the pool. The returned future becomes ready when the task has run and rethrows
+// anything it threw.
+std::future<void> pool_run(ThreadPool *pool, std::function<void()> task) {
+    std::shared_ptr<std::packaged_task<void()> > packaged = std::make_shared<std::packaged_task<void()> >(task);
+    std::future<void> done = packaged->get_future();
+    {
+        std::lock_guard<std::mutex> guard(pool->lock);
+        pool->tasks.push([packaged] { (*packaged)(); });
+    }
+    pool->ready.notify_one();
+    return done;
+}
 
-        std::getline(linestream, cell, ',');
-        pokemon.id = cell.empty() ? INT_MAX : std::stoi(cell);
+// Number of threads loadData uses, at least one.
+int loader_threads() {
+    return std::max(1, (int) std::thread::hardware_concurrency());
+}
 
-        std::getline(linestream, pokemon.identifier, ',');
+// Interned strings, stored back to back in one growable arena and referred to by their offset in it.
+// Equal strings are stored once, and rows holding offsets stay trivially copyable. A hash set of the
+// offsets finds existing strings; it is rebuilt from the arena on demand, so only chars needs saving.
+// A pool belongs to one thread at a time: loaders intern into pools of their own (see merge_pool).
+class StringPool {
+public:
+    std::vector<char> chars;         // NUL-terminated strings; offset 0 is the empty string
+    std::vector<unsigned int> slots; // Open-addressing set of the offsets in chars, 0 for an empty slot
+    unsigned int count;              // Strings in slots
 
-        std::getline(linestream, cell, ',');
-        pokemon.species_id = cell.empty() ? INT_MAX : std::stoi(cell);
+    StringPool() : chars(1, '\0'), count(0) {}
+};
 
-        std::getline(linestream, cell, ',');
-        pokemon.height = cell.empty() ? INT_MAX : std::stoi(cell);
+// Every identifier and name in the loaded tables
+StringPool identifiers;
 
-        std::getline(linestream, cell, ',');
-        pokemon.weight = cell.empty() ? INT_MAX : std::stoi(cell);
+// FNV-1a hash of an identifier.
+unsigned int hash_name(std::string_view name) {
+    unsigned int hash = 2166136261u;
+    for (unsigned char c : name) {
+        hash = (hash ^ c) * 16777619u;
+    }
+    return hash;
+}
 
-        std::getline(linestream, cell, ',');
-        pokemon.base_experience = cell.empty() ? INT_MAX : std::stoi(cell);
+// Empties a pool.
+void clear_pool(StringPool *pool) {
+    pool->chars.assign(1, '\0');
+    pool->slots.clear();
+    pool->count = 0;
+}
 
-        std::getline(linestream, cell, ',');
-        pokemon.order = cell.empty() ? INT_MAX : std::stoi(cell);
+// Rebuilds the hash set of a pool from its strings, with room for as many again.
+void rehash_pool(StringPool *pool) {
+    unsigned int count = 0;
+    for (size_t offset = 1; offset < pool->chars.size(); offset += strlen(&pool->chars[offset]) + 1) {
+        count++;
+    }
+    size_t capacity = 64;
+    while (capacity < 4 * (count + 1)) {
+        capacity *= 2;
+    }
+    pool->slots.assign(capacity, 0);
+    pool->count = count;
+    for (size_t offset = 1; offset < pool->chars.size(); offset += strlen(&pool->chars[offset]) + 1) {
+        size_t slot = hash_name(&pool->chars[offset]) & (capacity - 1);
+        while (pool->slots[slot] != 0) {
+            slot = (slot + 1) & (capacity - 1);
+        }
+        pool->slots[slot] = offset;
+    }
+}
 
-        std::getline(linestream, cell, ',');
-        pokemon.is_default = cell.empty() ? false : (cell == "1");
+// Returns the offset of name in a pool, adding it if it is new.
+unsigned int intern(StringPool *pool, std::string_view name) {
+    if (name.empty()) {
+        return 0;
+    }
+    if (2 * (pool->count + 1) > pool->slots.size()) {
+        rehash_pool(pool);
+    }
+    size_t mask = pool->slots.size() - 1;
+    size_t slot = hash_name(name) & mask;
+    for (; pool->slots[slot] != 0; slot = (slot + 1) & mask) {
+        if (name == &pool->chars[pool->slots[slot]]) {
+            return pool->slots[slot];
+        }
+    }
+    unsigned int offset = pool->chars.size();
+    pool->chars.insert(pool->chars.end(), name.begin(), name.end());
+    pool->chars.push_back('\0');
+    pool->slots[slot] = offset;
+    pool->count++;
+    return offset;
+}
 
-        pokemons.push_back(pokemon);
+// Adds the strings of part to pool, in the order part got them, and returns their offsets in pool
+// indexed by their offsets in part.
+std::vector<unsigned int> merge_pool(StringPool *pool, const StringPool& part) {
+    std::vector<unsigned int> offsets(part.chars.size(), 0);
+    for (size_t offset = 1; offset < part.chars.size(); offset += strlen(&part.chars[offset]) + 1) {
+        offsets[offset] = intern(pool, &part.chars[offset]);
     }
+    return offsets;
+}
 
-    return pokemons;
+// Returns an identifier of the loaded tables. The pointer is valid until the next table load.
+const char *name_of(unsigned int offset) {
+    return &identifiers.chars[offset];
 }
 
-std::vector<Move> parseMovesCSV(const std::string& filename) {
-    std::vector<Move> moves;
-    std::ifstream file(filename);
-    std::string line;
-    std::getline(file, line); // Skip the header line
+// local_language_id of the type names the game loads
+#define ENGLISH_LANGUAGE_ID 9
 
-    while (std::getline(file, line)) {
-        std::stringstream linestream(line);
-        std::string cell;
-        Move move;
+// How the CSV dump prints a column.
+enum ColumnKind { COLUMN_INT, COLUMN_STRING, COLUMN_FLAG };
+
+struct CsvColumn {
+    const char *name;  // Header name in the CSV
+    const char *label; // Label the CSV dump prints
+    ColumnKind kind;
+};
+
+// Every column of a pokedex CSV. The parsers below materialize only the columns the game reads and
+// skip the rest; the CSV dump decodes all of them from the file when asked for a table.
+struct CsvTable {
+    const char *name;
+    std::vector<CsvColumn> columns;
+    const char *filterColumn; // When set, only rows whose filterColumn equals filterValue are read
+    int filterValue;
+};
+
+const CsvTable pokedexSchema[] = {
+    {"pokemon", {{"id", "ID", COLUMN_INT}, {"identifier", "Identifier", COLUMN_STRING},
+                 {"species_id", "Species ID", COLUMN_INT}, {"height", "Height", COLUMN_INT},
+                 {"weight", "Weight", COLUMN_INT}, {"base_experience", "Base Experience", COLUMN_INT},
+                 {"order", "Order", COLUMN_INT}, {"is_default", "Is Default", COLUMN_FLAG}}, NULL, 0},
+    {"moves", {{"id", "ID", COLUMN_INT}, {"identifier", "Identifier", COLUMN_STRING},
+               {"generation_id", "Generation ID", COLUMN_INT}, {"type_id", "Type ID", COLUMN_INT},
+               {"power", "Power", COLUMN_INT}, {"pp", "PP", COLUMN_INT}, {"accuracy", "Accuracy", COLUMN_INT},
+               {"priority", "Priority", COLUMN_INT}, {"target_id", "Target ID", COLUMN_INT},
+               {"damage_class_id", "Damage Class ID", COLUMN_INT}, {"effect_id", "Effect ID", COLUMN_INT},
+               {"effect_chance", "Effect Chance", COLUMN_INT}, {"contest_type_id", "Contest Type ID", COLUMN_INT},
+               {"contest_effect_id", "Contest Effect ID", COLUMN_INT},
+               {"super_contest_effect_id", "Super Contest Effect ID", COLUMN_INT}}, NULL, 0},
+    {"pokemon_moves", {{"pokemon_id", "Pokemon ID", COLUMN_INT}, {"version_group_id", "Version ID", COLUMN_INT},
+                       {"move_id", "Move ID", COLUMN_INT},
+                       {"pokemon_move_method_id", "Pokemon Move Method ID", COLUMN_INT},
+                       {"level", "Level", COLUMN_INT}, {"order", "Order", COLUMN_INT}}, NULL, 0},
+    {"pokemon_species", {{"id", "ID", COLUMN_INT}, {"identifier", "Identifier", COLUMN_STRING},
+                         {"generation_id", "Generation ID", COLUMN_INT},
+                         {"evolves_from_species_id", "Evolves From Species ID", COLUMN_INT},
+                         {"evolution_chain_id", "Evolution Chain ID", COLUMN_INT}, {"color_id", "Color ID", COLUMN_INT},
+                         {"shape_id", "Shape ID", COLUMN_INT}, {"habitat_id", "Habitat ID", COLUMN_INT},
+                         {"gender_rate", "Gender Rate", COLUMN_INT}, {"capture_rate", "Capture Rate", COLUMN_INT},
+                         {"base_happiness", "Base Happiness", COLUMN_INT}, {"is_baby", "Is Baby", COLUMN_FLAG},
+                         {"hatch_counter", "Hatch Counter", COLUMN_INT},
+                         {"has_gender_differences", "Has Gender Differences", COLUMN_FLAG},
+                         {"growth_rate_id", "Growth Rate ID", COLUMN_INT},
+                         {"forms_switchable", "Forms Switchable", COLUMN_FLAG},
+                         {"is_legendary", "Is Legendary", COLUMN_FLAG}, {"is_mythical", "Is Mythical", COLUMN_FLAG},
+                         {"order", "Order", COLUMN_INT}, {"conquest_order", "Conquest Order", COLUMN_INT}}, NULL, 0},
+    {"experience", {{"growth_rate_id", "Growth Rate ID", COLUMN_INT}, {"level", "Level", COLUMN_INT},
+                    {"experience", "Experience", COLUMN_INT}}, NULL, 0},
+    {"type_names", {{"type_id", "Type ID", COLUMN_INT}, {"local_language_id", "Local Language ID", COLUMN_INT},
+                    {"name", "Name", COLUMN_STRING}}, "local_language_id", ENGLISH_LANGUAGE_ID},
+    {"pokemon_stats", {{"pokemon_id", "Pokemon ID", COLUMN_INT}, {"stat_id", "Stat ID", COLUMN_INT},
+                       {"base_stat", "Base Stat", COLUMN_INT}, {"effort", "Effort", COLUMN_INT}}, NULL, 0},
+    {"stats", {{"id", "ID", COLUMN_INT}, {"damage_class_id", "Damage Class ID", COLUMN_INT},
+               {"identifier", "Identifier", COLUMN_STRING}, {"is_battle_only", "Is Battle Only", COLUMN_FLAG},
+               {"game_index", "Game Index", COLUMN_INT}}, NULL, 0},
+    {"pokemon_types", {{"pokemon_id", "Pokemon ID", COLUMN_INT}, {"type_id", "Type ID", COLUMN_INT},
+                       {"slot", "Slot", COLUMN_INT}}, NULL, 0},
+    {"pokemon_habitats", {{"id", "ID", COLUMN_INT}, {"identifier", "Identifier", COLUMN_STRING}}, NULL, 0},
+};
+
+// Returns the schema of the named CSV, or NULL if it is not a pokedex table.
+const CsvTable *findCsvTable(const std::string& name) {
+    for (const CsvTable& table : pokedexSchema) {
+        if (name == table.name) {
+            return &table;
+        }
+    }
+    return NULL;
+}
+
+class CsvReader;
+bool csv_next_row(CsvReader *csv);
+
+// A CSV file mapped read-only into memory and read row by row. Cells are string_views into the
+// mapping, so nothing is copied until a parser stores a string field. Only the columns asked for
+// with csv_column are split out of each row. A missing or empty file reads as having no rows.
+class CsvReader {
+public:
+    const char *data;                     // The mapping, NULL for readers over part of another reader's mapping
+    size_t size;
+    const char *next;                     // Start of the next row
+    const char *end;                      // End of the rows to read
+    std::vector<std::string_view> header; // Column names from the first line
+    std::vector<std::string_view> cells;  // Cells of the current row, at most width of them
+    size_t width;                         // One past the last column asked for
+
+    // Reads the rows in [begin, end) of another reader's mapping, which must outlive this reader, with
+    // that reader's header.
+    CsvReader(const CsvReader *file, const char *begin, const char *end)
+        : data(NULL), size(0), next(begin), end(end), header(file->header), width(0) {}
+
+    CsvReader(const std::string& filename) : data(NULL), size(0), next(NULL), end(NULL), width(0) {
+        int fd = open(filename.c_str(), O_RDONLY);
+        if (fd == -1) {
+            return;
+        }
+        struct stat info;
+        if (fstat(fd, &info) == 0 && info.st_size > 0) {
+            void *mapped = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped != MAP_FAILED) {
+                data = (const char *) mapped;
+                size = info.st_size;
+                next = data;
+                end = data + size;
+            }
+        }
+        close(fd);
+        width = SIZE_MAX;
+        if (csv_next_row(this)) {
+            header.swap(cells);
+        }
+        width = 0;
+    }
 
-        std::getline(linestream, cell, ',');
-        move.id = cell.empty() ? INT_MAX : std::stoi(cell);
+    ~CsvReader() {
+        if (data != NULL) {
+            munmap((void *) data, size);
+        }
+    }
 
-        std::getline(linestream, move.identifier, ',');
+};
 
-        std::getline(linestream, cell, ',');
-        move.generation_id = cell.empty() ? INT_MAX : std::stoi(cell);
+// Returns the position of the column named name, or -1 if the file has no such column, and has
+// csv_next_row split rows at least up to it.
+int csv_column(CsvReader *csv, const char *name) {
+    for (size_t i = 0; i < csv->header.size(); i++) {
+        if (csv->header[i] == name) {
+            csv->width = std::max(csv->width, i + 1);
+            return (int) i;
+        }
+    }
+    return -1;
+}
 
-        std::getline(linestream, cell, ',');
-        move.type_id = cell.empty() ? INT_MAX : std::stoi(cell);
+// Moves to the next row and splits out its first width cells, returning false at the end of the file.
+bool csv_next_row(CsvReader *csv) {
+    const char *end = csv->end;
+    if (csv->next == NULL || csv->next >= end) {
+        return false;
+    }
+    const char *newline = (const char *) memchr(csv->next, '\n', end - csv->next);
+    const char *rowEnd = newline != NULL ? newline : end;
+    std::string_view row(csv->next, rowEnd - csv->next);
+    csv->next = rowEnd + 1;
+
+    csv->cells.clear();
+    while (csv->cells.size() < csv->width) {
+        size_t comma = row.find(',');
+        csv->cells.push_back(row.substr(0, comma));
+        if (comma == std::string_view::npos) {
+            break;
+        }
+        row.remove_prefix(comma + 1);
+    }
+    return true;
+}
 
-        std::getline(linestream, cell, ',');
-        move.power = cell.empty() ? INT_MAX : std::stoi(cell);
+// Returns a cell of the current row, or an empty view if the row is short or column is -1.
+std::string_view csv_cell(CsvReader *csv, int column) {
+    if (column < 0 || column >= (int) csv->cells.size()) {
+        return std::string_view();
+    }
+    return csv->cells[column];
+}
 
-        std::getline(linestream, cell, ',');
-        move.pp = cell.empty() ? INT_MAX : std::stoi(cell);
+// Reads a cell as an integer; empty or non-numeric cells read as INT_MAX.
+int csv_int(CsvReader *csv, int column) {
+    std::string_view cell = csv_cell(csv, column);
+    int value;
+    if (std::from_chars(cell.data(), cell.data() + cell.size(), value).ec != std::errc()) {
+        return INT_MAX;
+    }
+    return value;
+}
 
-        std::getline(linestream, cell, ',');
-        move.accuracy = cell.empty() ? INT_MAX : std::stoi(cell);
+// Reads a cell as an identifier interned into names.
+unsigned int csv_name(CsvReader *csv, int column, StringPool *names) {
+    return intern(names, csv_cell(csv, column));
+}
 
-        std::getline(linestream, cell, ',');
-        move.priority = cell.empty() ? INT_MAX : std::stoi(cell);
+// Reads a cell as a flag, set when the cell is "1".
+bool csv_flag(CsvReader *csv, int column) {
+    return csv_cell(csv, column) == "1";
+}
 
-        std::getline(linestream, cell, ',');
-        move.target_id = cell.empty() ? INT_MAX : std::stoi(cell);
+std::vector<Pokemon> parsePokemonCSV(const std::string& filename, StringPool *names) {
+    std::vector<Pokemon> pokemons;
+    CsvReader csv(filename);
+    int id = csv_column(&csv, "id");
+    int identifier = csv_column(&csv, "identifier");
+    int speciesId = csv_column(&csv, "species_id");
 
-        std::getline(linestream, cell, ',');
-        move.damage_class_id = cell.empty() ? INT_MAX : std::stoi(cell);
+    while (csv_next_row(&csv)) {
+        Pokemon pokemon;
 
-        std::getline(linestream, cell, ',');
-        move.effect_id = cell.empty() ? INT_MAX : std::stoi(cell);
+        pokemon.id = csv_int(&csv, id);
+        pokemon.identifier = csv_name(&csv, identifier, names);
+        pokemon.species_id = csv_int(&csv, speciesId);
 
-        std::getline(linestream, cell, ',');
-        move.effect_chance = cell.empty() ? INT_MAX : std::stoi(cell);
+        pokemons.push_back(pokemon);
+    }
 
-        std::getline(linestream, cell, ',');
-        move.contest_type_id = cell.empty() ? INT_MAX : std::stoi(cell);
+    return pokemons;
+}
 
-        std::getline(linestream, cell, ',');
-        move.contest_effect_id = cell.empty() ? INT_MAX : std::stoi(cell);
+std::vector<Move> parseMovesCSV(const std::string& filename, StringPool *names) {
+    std::vector<Move> moves;
+    CsvReader csv(filename);
+    int id = csv_column(&csv, "id");
+    int identifier = csv_column(&csv, "identifier");
+    int typeId = csv_column(&csv, "type_id");
+    int power = csv_column(&csv, "power");
+    int accuracy = csv_column(&csv, "accuracy");
+
+    while (csv_next_row(&csv)) {
+        Move move;
 
-        std::getline(linestream, cell, ',');
-        move.super_contest_effect_id = cell.empty() ? INT_MAX : std::stoi(cell);
+        move.id = csv_int(&csv, id);
+        move.identifier = csv_name(&csv, identifier, names);
+        move.type_id = csv_int(&csv, typeId);
+        move.power = csv_int(&csv, power);
+        move.accuracy = csv_int(&csv, accuracy);
 
         moves.push_back(move);
     }
@@ -285,429 +708,1703 @@ std::vector<Move> parseMovesCSV(const std::string& filename) {
     return moves;
 }
 
-std::vector<PokemonMove> parsePokemonMovesCSV(const std::string& filename) {
-    std::vector<PokemonMove> pokemonMoves;
-    std::ifstream file(filename);
-    std::string line;
-    std::getline(file, line); // Skip the header line
+// Appends the remaining rows of a pokemon_moves reader to pokemonMoves.
+void parsePokemonMovesRows(CsvReader *csv, std::vector<PokemonMove>& pokemonMoves) {
+    int pokemonId = csv_column(csv, "pokemon_id");
+    int moveId = csv_column(csv, "move_id");
+    int level = csv_column(csv, "level");
 
-    while (std::getline(file, line)) {
-        std::stringstream linestream(line);
-        std::string cell;
+    while (csv_next_row(csv)) {
         PokemonMove pokemonMove;
 
-        std::getline(linestream, cell, ',');
-        pokemonMove.pokemon_id = cell.empty() ? INT_MAX : std::stoi(cell);
-
-        std::getline(linestream, cell, ',');
-        pokemonMove.version_id = cell.empty() ? INT_MAX : std::stoi(cell);
-
-        std::getline(linestream, cell, ',');
-        pokemonMove.move_id = cell.empty() ? INT_MAX : std::stoi(cell);
+        pokemonMove.pokemon_id = csv_int(csv, pokemonId);
+        pokemonMove.move_id = csv_int(csv, moveId);
+        pokemonMove.level = csv_int(csv, level);
 
-        std::getline(linestream, cell, ',');
-        pokemonMove.pokemon_move_method_id = cell.empty() ? INT_MAX : std::stoi(cell);
+        pokemonMoves.push_back(pokemonMove);
+    }
+}
 
-        std::getline(linestream, cell, ',');
-        pokemonMove.level = cell.empty() ? INT_MAX : std::stoi(cell);
+// Parses pokemon_moves.csv. With a pool, the file is cut into one chunk per worker at row boundaries
+// and the chunks are parsed concurrently, then joined in file order. The caller must not be one of
+// the pool's workers, since it waits for the chunks.
+std::vector<PokemonMove> parsePokemonMovesCSV(const std::string& filename, ThreadPool *pool = NULL) {
+    std::vector<PokemonMove> pokemonMoves;
+    CsvReader csv(filename);
 
-        std::getline(linestream, cell, ',');
-        pokemonMove.order = cell.empty() ? INT_MAX : std::stoi(cell);
+    int numChunks = pool != NULL ? (int) pool->workers.size() : 1;
+    if (numChunks <= 1 || csv.next == NULL) {
+        parsePokemonMovesRows(&csv, pokemonMoves);
+        return pokemonMoves;
+    }
 
-        pokemonMoves.push_back(pokemonMove);
+    std::vector<const char *> bounds(1, csv.next);
+    for (int c = 1; c < numChunks; c++) {
+        const char *cut = bounds.back() + (csv.end - bounds.back()) / (numChunks - c + 1);
+        const char *newline = (const char *) memchr(cut, '\n', csv.end - cut);
+        bounds.push_back(newline != NULL ? newline + 1 : csv.end);
+    }
+    bounds.push_back(csv.end);
+
+    std::vector<std::vector<PokemonMove> > chunks(numChunks);
+    std::vector<std::future<void> > parsed;
+    for (int c = 0; c < numChunks; c++) {
+        const char *begin = bounds[c], *end = bounds[c + 1];
+        std::vector<PokemonMove> *chunk = &chunks[c];
+        const CsvReader *file = &csv;
+        parsed.push_back(pool_run(pool, [file, begin, end, chunk] {
+            CsvReader part(file, begin, end);
+            parsePokemonMovesRows(&part, *chunk);
+        }));
     }
 
+    size_t total = 0;
+    for (int c = 0; c < numChunks; c++) {
+        parsed[c].get();
+        total += chunks[c].size();
+    }
+    pokemonMoves.reserve(total);
+    for (int c = 0; c < numChunks; c++) {
+        pokemonMoves.insert(pokemonMoves.end(), chunks[c].begin(), chunks[c].end());
+    }
     return pokemonMoves;
 }
 
-std::vector<PokemonSpecies> parsePokemonSpeciesCSV(const std::string& filename) {
+std::vector<PokemonSpecies> parsePokemonSpeciesCSV(const std::string& filename, StringPool *names) {
     std::vector<PokemonSpecies> pokemonSpecies;
-    std::ifstream file(filename);
-    std::string line;
-    std::getline(file, line); // Skip the header line
+    CsvReader csv(filename);
+    int id = csv_column(&csv, "id");
+    int identifier = csv_column(&csv, "identifier");
+    int habitatId = csv_column(&csv, "habitat_id");
+    int growthRateId = csv_column(&csv, "growth_rate_id");
 
-    while (std::getline(file, line)) {
-        std::stringstream linestream(line);
-        std::string cell;
+    while (csv_next_row(&csv)) {
         PokemonSpecies species;
 
-        std::getline(linestream, cell, ',');
-        species.id = cell.empty() ? INT_MAX : std::stoi(cell);
+        species.id = csv_int(&csv, id);
+        species.identifier = csv_name(&csv, identifier, names);
+        species.habitat_id = csv_int(&csv, habitatId);
+        species.growth_rate_id = csv_int(&csv, growthRateId);
 
-        std::getline(linestream, species.identifier, ',');
+        pokemonSpecies.push_back(species);
+    }
 
-        std::getline(linestream, cell, ',');
-        species.generation_id = cell.empty() ? INT_MAX : std::stoi(cell);
+    return pokemonSpecies;
+}
 
-        std::getline(linestream, cell, ',');
-        species.evolves_from_species_id = cell.empty() ? INT_MAX : std::stoi(cell);
+std::vector<Experience> parseExperienceCSV(const std::string& filename) {
+    std::vector<Experience> experiences;
+    CsvReader csv(filename);
+    int growthRateId = csv_column(&csv, "growth_rate_id");
+    int level = csv_column(&csv, "level");
+    int experienceColumn = csv_column(&csv, "experience");
 
-        std::getline(linestream, cell, ',');
-        species.evolution_chain_id = cell.empty() ? INT_MAX : std::stoi(cell);
+    while (csv_next_row(&csv)) {
+        Experience experience;
 
-        std::getline(linestream, cell, ',');
-        species.color_id = cell.empty() ? INT_MAX : std::stoi(cell);
+        experience.growth_rate_id = csv_int(&csv, growthRateId);
+        experience.level = csv_int(&csv, level);
+        experience.experience = csv_int(&csv, experienceColumn);
 
-        std::getline(linestream, cell, ',');
-        species.shape_id = cell.empty() ? INT_MAX : std::stoi(cell);
+        experiences.push_back(experience);
+    }
 
-        std::getline(linestream, cell, ',');
-        species.habitat_id = cell.empty() ? INT_MAX : std::stoi(cell);
+    return experiences;
+}
 
-        std::getline(linestream, cell, ',');
-        species.gender_rate = cell.empty() ? INT_MAX : std::stoi(cell);
+std::vector<TypeName> parseTypeNamesCSV(const std::string& filename, StringPool *names) {
+    std::vector<TypeName> typeNames;
+    CsvReader csv(filename);
+    int typeId = csv_column(&csv, "type_id");
+    int language = csv_column(&csv, "local_language_id");
+    int name = csv_column(&csv, "name");
+
+    while (csv_next_row(&csv)) {
+        if (csv_int(&csv, language) != ENGLISH_LANGUAGE_ID) {
+            continue;
+        }
+        TypeName typeName;
 
-        std::getline(linestream, cell, ',');
-        species.capture_rate = cell.empty() ? INT_MAX : std::stoi(cell);
+        typeName.type_id = csv_int(&csv, typeId);
+        typeName.name = csv_name(&csv, name, names);
 
-        std::getline(linestream, cell, ',');
-        species.base_happiness = cell.empty() ? INT_MAX : std::stoi(cell);
+        typeNames.push_back(typeName);
+    }
 
-        std::getline(linestream, cell, ',');
-        species.is_baby = cell.empty() ? false : (cell == "1");
+    return typeNames;
+}
 
-        std::getline(linestream, cell, ',');
-        species.hatch_counter = cell.empty() ? INT_MAX : std::stoi(cell);
+std::vector<PokemonStat> parsePokemonStatsCSV(const std::string& filename) {
+    std::vector<PokemonStat> pokemonStats;
+    CsvReader csv(filename);
+    int pokemonId = csv_column(&csv, "pokemon_id");
+    int statId = csv_column(&csv, "stat_id");
+    int baseStat = csv_column(&csv, "base_stat");
 
-        std::getline(linestream, cell, ',');
-        species.has_gender_differences = cell.empty() ? false : (cell == "1");
+    while (csv_next_row(&csv)) {
+        PokemonStat pokemonStat;
 
-        std::getline(linestream, cell, ',');
-        species.growth_rate_id = cell.empty() ? INT_MAX : std::stoi(cell);
+        pokemonStat.pokemon_id = csv_int(&csv, pokemonId);
+        pokemonStat.stat_id = csv_int(&csv, statId);
+        pokemonStat.base_stat = csv_int(&csv, baseStat);
 
-        std::getline(linestream, cell, ',');
-        species.forms_switchable = cell.empty() ? false : (cell == "1");
+        pokemonStats.push_back(pokemonStat);
+    }
 
-        std::getline(linestream, cell, ',');
-        species.is_legendary = cell.empty() ? false : (cell == "1");
+    return pokemonStats;
+}
 
-        std::getline(linestream, cell, ',');
-        species.is_mythical = cell.empty() ? false : (cell == "1");
+std::vector<Stat> parseStatsCSV(const std::string& filename, StringPool *names) {
+    std::vector<Stat> stats;
+    CsvReader csv(filename);
+    int id = csv_column(&csv, "id");
+    int identifier = csv_column(&csv, "identifier");
 
-        std::getline(linestream, cell, ',');
-        species.order = cell.empty() ? INT_MAX : std::stoi(cell);
+    while (csv_next_row(&csv)) {
+        Stat stat;
 
-        std::getline(linestream, cell, ',');
-        species.conquest_order = cell.empty() ? INT_MAX : std::stoi(cell);
+        stat.id = csv_int(&csv, id);
+        stat.identifier = csv_name(&csv, identifier, names);
 
-        pokemonSpecies.push_back(species);
+        stats.push_back(stat);
     }
 
-    return pokemonSpecies;
+    return stats;
 }
 
-std::vector<Experience> parseExperienceCSV(const std::string& filename) {
-    std::vector<Experience> experiences;
-    std::ifstream file(filename);
-    std::string line;
-    std::getline(file, line); // Skip the header line
-
-    while (std::getline(file, line)) {
-        std::stringstream linestream(line);
-        std::string cell;
-        Experience experience;
-
-        std::getline(linestream, cell, ',');
-        experience.growth_rate_id = cell.empty() ? INT_MAX : std::stoi(cell);
+std::vector<PokemonType> parsePokemonTypesCSV(const std::string& filename) {
+    std::vector<PokemonType> pokemonTypes;
+    CsvReader csv(filename);
+    int pokemonId = csv_column(&csv, "pokemon_id");
+    int typeId = csv_column(&csv, "type_id");
 
-        std::getline(linestream, cell, ',');
-        experience.level = cell.empty() ? INT_MAX : std::stoi(cell);
+    while (csv_next_row(&csv)) {
+        PokemonType pokemonType;
 
-        std::getline(linestream, cell, ',');
-        experience.experience = cell.empty() ? INT_MAX : std::stoi(cell);
+        pokemonType.pokemon_id = csv_int(&csv, pokemonId);
+        pokemonType.type_id = csv_int(&csv, typeId);
 
-        experiences.push_back(experience);
+        pokemonTypes.push_back(pokemonType);
     }
 
-    return experiences;
+    return pokemonTypes;
 }
 
-std::vector<TypeName> parseTypeNamesCSV(const std::string& filename) {
-    std::vector<TypeName> typeNames;
-    std::ifstream file(filename);
-    std::string line;
-    std::getline(file, line); // Skip the header line
-
-    while (std::getline(file, line)) {
-        std::stringstream linestream(line);
-        std::string cell;
-        TypeName typeName;
-
-        std::getline(linestream, cell, ',');
-        typeName.type_id = cell.empty() ? INT_MAX : std::stoi(cell);
+std::vector<PokemonHabitat> parsePokemonHabitatsCSV(const std::string& filename, StringPool *names) {
+    std::vector<PokemonHabitat> pokemonHabitats;
+    CsvReader csv(filename);
+    int id = csv_column(&csv, "id");
+    int identifier = csv_column(&csv, "identifier");
 
-        std::getline(linestream, cell, ',');
-        typeName.local_language_id = cell.empty() ? INT_MAX : std::stoi(cell);
+    while (csv_next_row(&csv)) {
+        PokemonHabitat habitat;
 
-        std::getline(linestream, typeName.name, ',');
+        habitat.id = csv_int(&csv, id);
+        habitat.identifier = csv_name(&csv, identifier, names);
 
-        typeNames.push_back(typeName);
+        pokemonHabitats.push_back(habitat);
     }
 
-    return typeNames;
+    return pokemonHabitats;
 }
 
-std::vector<PokemonStat> parsePokemonStatsCSV(const std::string& filename) {
-    std::vector<PokemonStat> pokemonStats;
-    std::ifstream file(filename);
-    std::string line;
-    std::getline(file, line); // Skip the header line
-
-    while (std::getline(file, line)) {
-        std::stringstream linestream(line);
-        std::string cell;
-        PokemonStat pokemonStat;
+bool fileExists(const std::string& filePath) {
+    std::ifstream file(filePath);
+    return file.good();
+}
 
-        std::getline(linestream, cell, ',');
-        pokemonStat.pokemon_id = cell.empty() ? INT_MAX : std::stoi(cell);
+// Declare global variables
+std::vector<Pokemon> allPokemons;
+std::vector<Move> allMoves;
+std::vector<PokemonMove> allPokemonMoves;
+std::vector<PokemonSpecies> allPokemonSpecies;
+std::vector<Experience> allExperiences;
+std::vector<TypeName> allTypeNames;
+std::vector<PokemonStat> allPokemonStats;
+std::vector<Stat> allStats;
+std::vector<PokemonType> allPokemonTypes;
+std::vector<PokemonHabitat> allPokemonHabitats;
 
-        std::getline(linestream, cell, ',');
-        pokemonStat.stat_id = cell.empty() ? INT_MAX : std::stoi(cell);
+// Directory searched for the pokedex files before the standard locations, when set
+std::string pokedexDir;
 
-        std::getline(linestream, cell, ',');
-        pokemonStat.base_stat = cell.empty() ? INT_MAX : std::stoi(cell);
+// Returns the path of a file in the first pokedex location that has it, or "" if none does.
+std::string findPokedexFile(const std::string& fileName) {
+    std::string filePath;
 
-        std::getline(linestream, cell, ',');
-        pokemonStat.effort = cell.empty() ? INT_MAX : std::stoi(cell);
+    // Try the directory given on the command line, if any
+    if (!pokedexDir.empty()) {
+        filePath = pokedexDir + "/" + fileName;
+        if (fileExists(filePath)) {
+            return filePath;
+        }
+    }
 
-        pokemonStats.push_back(pokemonStat);
+    // Try the first location
+    filePath = "/share/Pokemon-Text-Based-Game/pokedex/pokedex/data/csv/" + fileName;
+    if (fileExists(filePath)) {
+        return filePath;
     }
 
-    return pokemonStats;
-}
+    // Try the second location
+    const char* homeDir = getenv("HOME");
+    if (homeDir != nullptr) {
+        filePath = std::string(homeDir) + "/.poke327/pokedex/pokedex/data/csv/" + fileName;
+        if (fileExists(filePath)) {
+            return filePath;
+        }
+    }
 
-std::vector<Stat> parseStatsCSV(const std::string& filename) {
-    std::vector<Stat> stats;
-    std::ifstream file(filename);
-    std::string line;
-    std::getline(file, line); // Skip the header line
+    // Try the third location
+    filePath = "c:/Pokemon-Text-Based-Game/pokedex/pokedex/data/csv/" + fileName;
+    if (fileExists(filePath)) {
+        return filePath;
+    }
 
-    while (std::getline(file, line)) {
-        std::stringstream linestream(line);
-        std::string cell;
-        Stat stat;
+    // If the file is not found in any location, return an empty string
+    return "";
+}
 
-        std::getline(linestream, cell, ',');
-        stat.id = cell.empty() ? INT_MAX : std::stoi(cell);
+// Returns the path of a table's CSV, or "" if it is not found.
+std::string findFilePath(const std::string& fileType) {
+    return findPokedexFile(fileType + ".csv");
+}
 
-        std::getline(linestream, cell, ',');
-        stat.damage_class_id = cell.empty() ? INT_MAX : std::stoi(cell);
+// Returns the schema of a table's column, or NULL if the table has no column called name.
+const CsvColumn *findCsvColumn(const CsvTable *table, const std::string& name) {
+    for (const CsvColumn& column : table->columns) {
+        if (name == column.name) {
+            return &column;
+        }
+    }
+    return NULL;
+}
 
-        std::getline(linestream, stat.identifier, ',');
+// A --where condition of the query mode. Integer columns are compared by value, others by their text.
+struct QueryFilter {
+    const CsvColumn *column;
+    std::string value;
+    int number; // value as an integer, INT_MAX if it is empty or not a number
+    int index;  // Position of the column in the file
+};
 
-        std::getline(linestream, cell, ',');
-        stat.is_battle_only = cell == "1";
+// Appends a cell to a query output line the way the column is printed: integers and strings as "N/A"
+// when empty, flags as Yes/No.
+void append_cell(std::string& out, CsvReader *csv, const CsvColumn *column, int index) {
+    if (column->kind == COLUMN_INT) {
+        int value = csv_int(csv, index);
+        if (value == INT_MAX) {
+            out += "N/A";
+        } else {
+            char digits[16];
+            out.append(digits, std::to_chars(digits, digits + sizeof digits, value).ptr);
+        }
+    } else if (column->kind == COLUMN_STRING) {
+        std::string_view value = csv_cell(csv, index);
+        out += !value.empty() ? value : std::string_view("N/A");
+    } else {
+        out += csv_flag(csv, index) ? "Yes" : "No";
+    }
+}
 
-        std::getline(linestream, cell, ',');
-        stat.game_index = cell.empty() ? INT_MAX : std::stoi(cell);
+// Runs "query <table> [--where column=value]... [--cols column,...]": streams the rows of a pokedex
+// CSV matching every --where, printing the --cols columns (all of them by default) as "Label: value"
+// lines. Rows are decoded one at a time straight from the mapped file and the output is written in
+// large blocks, so nothing is loaded into tables and dumps are bound by I/O rather than line flushes.
+// A table's row filter (English type names only) applies unless a --where names the same column.
+int runQuery(int argc, char *argv[]) {
+    const CsvTable *table = findCsvTable(argv[0]);
+    if (table == NULL) {
+        std::cerr << "Error: Invalid file type specified." << std::endl;
+        return 1;
+    }
 
-        stats.push_back(stat);
+    std::vector<const CsvColumn *> columns;
+    std::vector<QueryFilter> filters;
+    for (int i = 1; i < argc; i++) {
+        bool where = strcmp(argv[i], "--where") == 0;
+        if ((!where && strcmp(argv[i], "--cols") != 0) || i + 1 == argc) {
+            std::cerr << "Usage: Poke query <table> [--where column=value]... [--cols column,...]" << std::endl;
+            return 1;
+        }
+        std::string arg = argv[++i];
+        std::vector<std::string> names;
+        if (where) {
+            names.push_back(arg.substr(0, arg.find('=')));
+        } else {
+            size_t start = 0, comma;
+            while ((comma = arg.find(',', start)) != std::string::npos) {
+                names.push_back(arg.substr(start, comma - start));
+                start = comma + 1;
+            }
+            names.push_back(arg.substr(start));
+        }
+        for (const std::string& name : names) {
+            const CsvColumn *column = findCsvColumn(table, name);
+            if (column == NULL) {
+                std::cerr << "Error: " << table->name << " has no column " << name << "." << std::endl;
+                return 1;
+            }
+            if (!where) {
+                columns.push_back(column);
+            } else if (arg.find('=') == std::string::npos) {
+                std::cerr << "Error: --where expects column=value." << std::endl;
+                return 1;
+            } else {
+                QueryFilter filter;
+                filter.column = column;
+                filter.value = arg.substr(arg.find('=') + 1);
+                filter.number = INT_MAX;
+                std::from_chars(filter.value.data(), filter.value.data() + filter.value.size(), filter.number);
+                filters.push_back(filter);
+            }
+        }
+    }
+    if (columns.empty()) {
+        for (const CsvColumn& column : table->columns) {
+            columns.push_back(&column);
+        }
+    }
+    if (table->filterColumn != NULL) {
+        bool overridden = false;
+        for (const QueryFilter& filter : filters) {
+            overridden = overridden || strcmp(filter.column->name, table->filterColumn) == 0;
+        }
+        if (!overridden) {
+            QueryFilter filter;
+            filter.column = findCsvColumn(table, table->filterColumn);
+            filter.value = std::to_string(table->filterValue);
+            filter.number = table->filterValue;
+            filters.push_back(filter);
+        }
+    }
+
+    std::string filePath = findFilePath(table->name);
+    if (filePath.empty()) {
+        std::cerr << "Error: File not found in any of the specified locations." << std::endl;
+        return 1;
+    }
+    CsvReader csv(filePath);
+    std::vector<int> indexes;
+    for (const CsvColumn *column : columns) {
+        indexes.push_back(csv_column(&csv, column->name));
+    }
+    for (QueryFilter& filter : filters) {
+        filter.index = csv_column(&csv, filter.column->name);
+    }
+
+    std::string out;
+    out.reserve(1 << 17);
+    while (csv_next_row(&csv)) {
+        bool match = true;
+        for (const QueryFilter& filter : filters) {
+            if (filter.column->kind == COLUMN_INT) {
+                match = csv_int(&csv, filter.index) == filter.number;
+            } else {
+                match = csv_cell(&csv, filter.index) == filter.value;
+            }
+            if (!match) {
+                break;
+            }
+        }
+        if (!match) {
+            continue;
+        }
+        for (size_t c = 0; c < columns.size(); c++) {
+            if (c > 0) {
+                out += ", ";
+            }
+            out += columns[c]->label;
+            out += ": ";
+            append_cell(out, &csv, columns[c], indexes[c]);
+        }
+        out += '\n';
+        if (out.size() >= (1 << 16)) {
+            fwrite(out.data(), 1, out.size(), stdout);
+            out.clear();
+        }
+    }
+    fwrite(out.data(), 1, out.size(), stdout);
+    return 0;
+}
+
+// Lookup tables over the loaded CSV data, rebuilt by loadData. Ids index dense arrays directly
+// (-1 marks ids with no row), so finding a move, species or experience threshold never scans a table.
+class Pokedex {
+public:
+    std::vector<int> moveRow;           // Row in allMoves of each move id
+    std::vector<int> speciesRow;        // Row in allPokemonSpecies of each species id
+    // Experience needed to reach each level, per growth rate id; INT_MAX where the table has no entry
+    std::vector<std::vector<int> > experience;
+    std::vector<BaseStats> baseStats;   // Base stats of each pokemon id, all zero where it has none
+    // Learnsets in compressed sparse rows: the learnable moves of pokemon id p are rows
+    // [learnsetStart[p], learnsetStart[p + 1]) of the learn* arrays, sorted by level and otherwise
+    // in pokemon_moves.csv order
+    std::vector<int> learnsetStart;
+    std::vector<int> learnLevel;
+    std::vector<int> learnMoveId;
+    std::vector<int> learnMoveRow;      // Row in allMoves of the move, -1 if moves.csv lacks it
+    std::vector<unsigned int> typeMask; // Types of each pokemon id, as typeBit(type id) bits
+};
+
+// A contiguous run of learnset rows in pokedex, [begin, end).
+struct LearnsetSlice {
+    int begin;
+    int end;
+};
+
+Pokedex pokedex;
+
+// Damage multiplier in percent of a move of each attacking type (row) against each defending type
+// (column), indexed by type id - 1.
+constexpr unsigned char TYPE_EFFECTIVENESS[NUM_TYPES][NUM_TYPES] = {
+    {100, 100, 100, 100, 100,  50, 100,   0,  50, 100, 100, 100, 100, 100, 100, 100, 100, 100}, // normal
+    {200, 100,  50,  50, 100, 200,  50,   0, 200, 100, 100, 100, 100,  50, 200, 100, 200,  50}, // fighting
+    {100, 200, 100, 100, 100,  50, 200, 100,  50, 100, 100, 200,  50, 100, 100, 100, 100, 100}, // flying
+    {100, 100, 100,  50,  50,  50, 100,  50,   0, 100, 100, 200, 100, 100, 100, 100, 100, 200}, // poison
+    {100, 100,   0, 200, 100, 200,  50, 100, 200, 200, 100,  50, 200, 100, 100, 100, 100, 100}, // ground
+    {100,  50, 200, 100,  50, 100, 200, 100,  50, 200, 100, 100, 100, 100, 200, 100, 100, 100}, // rock
+    {100,  50,  50,  50, 100, 100, 100,  50,  50,  50, 100, 200, 100, 200, 100, 100, 200,  50}, // bug
+    {  0, 100, 100, 100, 100, 100, 100, 200, 100, 100, 100, 100, 100, 200, 100, 100,  50, 100}, // ghost
+    {100, 100, 100, 100, 100, 200, 100, 100,  50,  50,  50, 100,  50, 100, 200, 100, 100, 200}, // steel
+    {100, 100, 100, 100, 100,  50, 200, 100, 200,  50,  50, 200, 100, 100, 200,  50, 100, 100}, // fire
+    {100, 100, 100, 100, 200, 200, 100, 100, 100, 200,  50,  50, 100, 100, 100,  50, 100, 100}, // water
+    {100, 100,  50,  50, 200, 200,  50, 100,  50,  50, 200,  50, 100, 100, 100,  50, 100, 100}, // grass
+    {100, 100, 200, 100,   0, 100, 100, 100, 100, 100, 200,  50,  50, 100, 100,  50, 100, 100}, // electric
+    {100, 200, 100, 200, 100, 100, 100, 100,  50, 100, 100, 100, 100,  50, 100, 100,   0, 100}, // psychic
+    {100, 100, 200, 100, 200, 100, 100, 100,  50,  50,  50, 200, 100, 100,  50, 200, 100, 100}, // ice
+    {100, 100, 100, 100, 100, 100, 100, 100,  50, 100, 100, 100, 100, 100, 100, 200, 100,   0}, // dragon
+    {100,  50, 100, 100, 100, 100, 100, 200, 100, 100, 100, 100, 100, 200, 100, 100,  50,  50}, // dark
+    {100, 200, 100,  50, 100, 100, 100, 100,  50,  50, 100, 100, 100, 100, 100, 200, 200, 100}, // fairy
+};
+
+// Returns the typeMask bit of a type id, or 0 for types without effectiveness data.
+unsigned int typeBit(int typeId) {
+    return typeId >= 1 && typeId <= NUM_TYPES ? 1u << (typeId - 1) : 0;
+}
+
+// Returns the types of a pokemon id as typeBit bits.
+unsigned int typeMaskOf(int pokemonId) {
+    if (pokemonId < 0 || pokemonId >= (int) pokedex.typeMask.size()) {
+        return 0;
+    }
+    return pokedex.typeMask[pokemonId];
+}
+
+// Returns the damage multiplier of a move type against a defender's types, in percent.
+int typeEffectiveness(int moveTypeId, unsigned int defenderTypes) {
+    if (moveTypeId < 1 || moveTypeId > NUM_TYPES) {
+        return 100;
+    }
+    const unsigned char *row = TYPE_EFFECTIVENESS[moveTypeId - 1];
+    int percent = 100;
+    for (unsigned int types = defenderTypes; types != 0; types &= types - 1) {
+        percent = percent * row[__builtin_ctz(types)] / 100;
+    }
+    return percent;
+}
+
+// Grows a dense id table so id is a valid index, filling new entries with fill.
+template <typename T>
+void reserve_id(std::vector<T>& table, int id, T fill) {
+    if (id >= (int) table.size()) {
+        table.resize(id + 1, fill);
+    }
+}
+
+// Indexes the loaded tables into pokedex.
+void buildPokedex() {
+    pokedex = Pokedex();
+
+    for (int row = 0; row < (int) allMoves.size(); row++) {
+        int id = allMoves[row].id;
+        if (id >= 0 && id != INT_MAX) {
+            reserve_id(pokedex.moveRow, id, -1);
+            if (pokedex.moveRow[id] == -1) {
+                pokedex.moveRow[id] = row;
+            }
+        }
+    }
+
+    for (int row = 0; row < (int) allPokemonSpecies.size(); row++) {
+        int id = allPokemonSpecies[row].id;
+        if (id >= 0 && id != INT_MAX) {
+            reserve_id(pokedex.speciesRow, id, -1);
+            if (pokedex.speciesRow[id] == -1) {
+                pokedex.speciesRow[id] = row;
+            }
+        }
+    }
+
+    for (const auto& exp : allExperiences) {
+        if (exp.growth_rate_id < 0 || exp.growth_rate_id == INT_MAX || exp.level < 0 || exp.level == INT_MAX) {
+            continue;
+        }
+        if (exp.growth_rate_id >= (int) pokedex.experience.size()) {
+            pokedex.experience.resize(exp.growth_rate_id + 1);
+        }
+        std::vector<int>& levels = pokedex.experience[exp.growth_rate_id];
+        reserve_id(levels, exp.level, INT_MAX);
+        if (levels[exp.level] == INT_MAX) {
+            levels[exp.level] = exp.experience;
+        }
+    }
+
+    // A later row for the same stat overrides an earlier one, as the old scans did
+    for (const auto& stat : allPokemonStats) {
+        if (stat.pokemon_id < 0 || stat.pokemon_id == INT_MAX || stat.stat_id < 1 || stat.stat_id > NUM_STATS) {
+            continue;
+        }
+        if (stat.pokemon_id >= (int) pokedex.baseStats.size()) {
+            pokedex.baseStats.resize(stat.pokemon_id + 1, BaseStats());
+        }
+        pokedex.baseStats[stat.pokemon_id].stat[stat.stat_id - 1] = stat.base_stat;
+    }
+
+    // Bucket the learnset rows by pokemon id, keeping file order, then sort each bucket by level
+    for (const auto& pokemonMove : allPokemonMoves) {
+        if (pokemonMove.pokemon_id >= 0 && pokemonMove.pokemon_id != INT_MAX) {
+            reserve_id(pokedex.learnsetStart, pokemonMove.pokemon_id + 1, 0);
+            pokedex.learnsetStart[pokemonMove.pokemon_id + 1]++;
+        }
+    }
+    for (int p = 1; p < (int) pokedex.learnsetStart.size(); p++) {
+        pokedex.learnsetStart[p] += pokedex.learnsetStart[p - 1];
+    }
+    std::vector<int> order(pokedex.learnsetStart.empty() ? 0 : pokedex.learnsetStart.back());
+    std::vector<int> next(pokedex.learnsetStart);
+    for (int row = 0; row < (int) allPokemonMoves.size(); row++) {
+        int id = allPokemonMoves[row].pokemon_id;
+        if (id >= 0 && id != INT_MAX) {
+            order[next[id]++] = row;
+        }
+    }
+    for (int p = 0; p + 1 < (int) pokedex.learnsetStart.size(); p++) {
+        std::stable_sort(order.begin() + pokedex.learnsetStart[p], order.begin() + pokedex.learnsetStart[p + 1],
+                         [](int a, int b) { return allPokemonMoves[a].level < allPokemonMoves[b].level; });
+    }
+    for (int row : order) {
+        const PokemonMove& pokemonMove = allPokemonMoves[row];
+        int moveId = pokemonMove.move_id;
+        bool known = moveId >= 0 && moveId < (int) pokedex.moveRow.size();
+        pokedex.learnLevel.push_back(pokemonMove.level);
+        pokedex.learnMoveId.push_back(moveId);
+        pokedex.learnMoveRow.push_back(known ? pokedex.moveRow[moveId] : -1);
+    }
+
+    for (const auto& pokemonType : allPokemonTypes) {
+        if (pokemonType.pokemon_id >= 0 && pokemonType.pokemon_id != INT_MAX) {
+            reserve_id(pokedex.typeMask, pokemonType.pokemon_id, 0u);
+            pokedex.typeMask[pokemonType.pokemon_id] |= typeBit(pokemonType.type_id);
+        }
+    }
+}
+
+// Returns the learnset rows of a pokemon id with a level in [minLevel, maxLevel].
+LearnsetSlice learnsetBetween(int pokemonId, int minLevel, int maxLevel) {
+    LearnsetSlice slice = {0, 0};
+    if (pokemonId < 0 || pokemonId + 1 >= (int) pokedex.learnsetStart.size()) {
+        return slice;
+    }
+    std::vector<int>::const_iterator first = pokedex.learnLevel.begin() + pokedex.learnsetStart[pokemonId];
+    std::vector<int>::const_iterator last = pokedex.learnLevel.begin() + pokedex.learnsetStart[pokemonId + 1];
+    slice.begin = std::lower_bound(first, last, minLevel) - pokedex.learnLevel.begin();
+    slice.end = std::upper_bound(first, last, maxLevel) - pokedex.learnLevel.begin();
+    if (slice.end < slice.begin) {
+        slice.end = slice.begin;
+    }
+    return slice;
+}
+
+// Returns the learnset rows of a pokemon id it can know at the given level.
+LearnsetSlice learnableMoves(int pokemonId, int level) {
+    return learnsetBetween(pokemonId, INT_MIN, level);
+}
+
+// Returns the lowest level at which a pokemon id can know any move, or INT_MAX if it has no learnset.
+int firstLearnLevel(int pokemonId) {
+    if (pokemonId < 0 || pokemonId + 1 >= (int) pokedex.learnsetStart.size() ||
+        pokedex.learnsetStart[pokemonId] == pokedex.learnsetStart[pokemonId + 1]) {
+        return INT_MAX;
+    }
+    return pokedex.learnLevel[pokedex.learnsetStart[pokemonId]];
+}
+
+// Returns the move with the given id, or nullptr if moves.csv has none.
+Move* moveById(int moveId) {
+    if (moveId < 0 || moveId >= (int) pokedex.moveRow.size() || pokedex.moveRow[moveId] == -1) {
+        return nullptr;
+    }
+    return &allMoves[pokedex.moveRow[moveId]];
+}
+
+// Returns the identifier of a move id, for display.
+const char *move_name(int moveId) {
+    Move *move = moveById(moveId);
+    return move != nullptr ? name_of(move->identifier) : "";
+}
+
+// Makes a team Pokemon the given pokemon.
+void setPokemon(PokemonWithMoves *pokemon, const Pokemon& row) {
+    pokemon->identifier = row.identifier;
+    pokemon->pokemon_id = row.id;
+    pokemon->species_id = row.species_id;
+}
+
+// Teaches a Pokemon a move id, unless it already knows MAX_MOVES moves.
+void add_move(PokemonWithMoves *pokemon, int moveId) {
+    if (pokemon->numMoves < MAX_MOVES) {
+        pokemon->moves[pokemon->numMoves++] = moveId;
+    }
+}
+
+// Returns the base stats of a pokemon id, all zero if it has none.
+const BaseStats& baseStatsOf(int pokemonId) {
+    static const BaseStats none = BaseStats();
+    if (pokemonId < 0 || pokemonId >= (int) pokedex.baseStats.size()) {
+        return none;
+    }
+    return pokedex.baseStats[pokemonId];
+}
+
+// Moves the names a loader interned into part over to the identifiers pool and points rows at them.
+template <typename Row> void merge_names(std::vector<Row>& rows, unsigned int Row::*name, const StringPool& part) {
+    std::vector<unsigned int> offsets = merge_pool(&identifiers, part);
+    for (Row& row : rows) {
+        row.*name = offsets[row.*name];
+    }
+}
+
+// Parses every table from the CSVs. The tables are independent, so the small ones load concurrently on
+// a thread pool while this thread splits pokemon_moves, by far the largest, into chunks on the same pool.
+// Each loader interns names into its own pool; once all are done, the pools are merged in table order,
+// so names get the same offsets on every load however the loaders were scheduled.
+void loadCsvData() {
+    clear_pool(&identifiers);
+    StringPool pokemonNames, moveNames, speciesNames, typeNames, statNames, habitatNames;
+    ThreadPool pool(loader_threads());
+    std::vector<std::future<void> > loads;
+    loads.push_back(pool_run(&pool, [&] { allPokemons = parsePokemonCSV(findFilePath("pokemon"), &pokemonNames); }));
+    loads.push_back(pool_run(&pool, [&] { allMoves = parseMovesCSV(findFilePath("moves"), &moveNames); }));
+    loads.push_back(pool_run(&pool, [&] { allPokemonSpecies = parsePokemonSpeciesCSV(findFilePath("pokemon_species"), &speciesNames); }));
+    loads.push_back(pool_run(&pool, [] { allExperiences = parseExperienceCSV(findFilePath("experience")); }));
+    loads.push_back(pool_run(&pool, [&] { allTypeNames = parseTypeNamesCSV(findFilePath("type_names"), &typeNames); }));
+    loads.push_back(pool_run(&pool, [] { allPokemonStats = parsePokemonStatsCSV(findFilePath("pokemon_stats")); }));
+    loads.push_back(pool_run(&pool, [&] { allStats = parseStatsCSV(findFilePath("stats"), &statNames); }));
+    loads.push_back(pool_run(&pool, [] { allPokemonTypes = parsePokemonTypesCSV(findFilePath("pokemon_types")); }));
+    loads.push_back(pool_run(&pool, [&] { allPokemonHabitats = parsePokemonHabitatsCSV(findFilePath("pokemon_habitats"), &habitatNames); }));
+    allPokemonMoves = parsePokemonMovesCSV(findFilePath("pokemon_moves"), &pool);
+    for (std::future<void>& load : loads) {
+        load.get();
+    }
+    merge_names(allPokemons, &Pokemon::identifier, pokemonNames);
+    merge_names(allMoves, &Move::identifier, moveNames);
+    merge_names(allPokemonSpecies, &PokemonSpecies::identifier, speciesNames);
+    merge_names(allTypeNames, &TypeName::name, typeNames);
+    merge_names(allStats, &Stat::identifier, statNames);
+    merge_names(allPokemonHabitats, &PokemonHabitat::identifier, habitatNames);
+    buildPokedex();
+}
+
+// Binary snapshot of the loaded pokedex, kept next to the CSVs and found the same way (see snapshotPath)
+#define SNAPSHOT_FILE "pokedex.snap"
+// Bump whenever a snapshotted table changes layout or the format changes, so old snapshots read as stale
+#define SNAPSHOT_VERSION 3
+
+// Tables loadData reads, by CSV file name
+#define NUM_POKEDEX_TABLES 10
+const char *const pokedexTables[NUM_POKEDEX_TABLES] = {"pokemon", "moves", "pokemon_moves", "pokemon_species",
+                                                       "experience", "type_names", "pokemon_stats", "stats",
+                                                       "pokemon_types", "pokemon_habitats"};
+
+// Returns where to look for the snapshot: the first pokedex location that has one, or "" if none does.
+std::string snapshotPath() {
+    return findPokedexFile(SNAPSHOT_FILE);
+}
+
+// Returns where --build-snapshot writes by default: next to the CSVs, where snapshotPath finds it.
+std::string defaultSnapshotPath() {
+    std::string csv = findFilePath("pokemon");
+    size_t slash = csv.rfind('/');
+    return slash == std::string::npos ? SNAPSHOT_FILE : csv.substr(0, slash + 1) + SNAPSHOT_FILE;
+}
+
+// A CSV a snapshot is built from. Size and modification time are -1 for a file that cannot be read.
+struct SnapshotSource {
+    int64_t size;
+    int64_t mtime;
+    uint64_t checksum; // csvChecksum of the file
+};
+
+// Returns the size and modification time of the file at path, without its checksum.
+SnapshotSource sourceOf(const std::string& path) {
+    SnapshotSource source = {-1, -1, 0};
+    struct stat info;
+    if (!path.empty() && stat(path.c_str(), &info) == 0) {
+        source.size = info.st_size;
+        source.mtime = info.st_mtime;
+    }
+    return source;
+}
+
+// Folds size bytes into a 64-bit FNV-1a hash.
+uint64_t fnv1a64(uint64_t hash, const void *data, size_t size) {
+    const unsigned char *bytes = (const unsigned char *) data;
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+    }
+    return hash;
+}
+
+// Returns the FNV-1a hash of a CSV's contents, mapped the way the parsers read it.
+uint64_t csvChecksum(const std::string& path) {
+    CsvReader csv(path);
+    return fnv1a64(14695981039346656037ull, csv.data, csv.size);
+}
+
+// Calls f on every column of a row, in snapshot order. Tables of trivially copyable rows are stored as
+// raw arrays and never visited field by field.
+template <typename F> void visit_fields(std::vector<int>& r, F& f) {
+    f(r);
+}
+
+// Calls f on every table loadData fills, in snapshot order. The pool's hash set is rebuilt on demand.
+template <typename F> void visit_tables(F& f) {
+    f(identifiers.chars);
+    f(allPokemons); f(allMoves); f(allPokemonMoves); f(allPokemonSpecies); f(allExperiences); f(allTypeNames);
+    f(allPokemonStats); f(allStats); f(allPokemonTypes); f(allPokemonHabitats);
+    f(pokedex.moveRow); f(pokedex.speciesRow); f(pokedex.experience);
+    f(pokedex.baseStats); f(pokedex.learnsetStart); f(pokedex.learnLevel); f(pokedex.learnMoveId);
+    f(pokedex.learnMoveRow); f(pokedex.typeMask);
+}
+
+// Start of a snapshot file. It is followed by the path each CSV was read from, NUL-terminated in
+// pokedexTables order, and then by the tables to the end of the file. The snapshot is current while
+// every table still resolves to the same path and that file has the recorded contents.
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t pathsSize;                         // Bytes of CSV paths after the header
+    SnapshotSource sources[NUM_POKEDEX_TABLES]; // Each CSV as it was when the snapshot was built
+};
+
+const char SNAPSHOT_MAGIC[8] = {'P', 'K', 'D', 'X', 'S', 'N', 'A', 'P'};
+
+// Serializes tables: each is a uint64 row count and a uint32 row size, 0 for rows stored field by
+// field, followed by its rows.
+class SnapshotWriter {
+public:
+    std::string bytes;
+
+    void put(const void *data, size_t size) {
+        bytes.append((const char *) data, size);
+    }
+
+    template <typename T> void operator()(std::vector<T>& table) {
+        uint64_t count = table.size();
+        uint32_t rowSize = std::is_trivially_copyable<T>::value ? sizeof(T) : 0;
+        put(&count, sizeof count);
+        put(&rowSize, sizeof rowSize);
+        if constexpr (std::is_trivially_copyable<T>::value) {
+            put(table.data(), count * sizeof(T));
+        } else {
+            for (T& row : table) {
+                visit_fields(row, *this);
+            }
+        }
+    }
+};
+
+// Reads tables written by SnapshotWriter from a mapped snapshot. Any read past the end or mismatch in
+// row size clears ok, after which nothing more is read.
+class SnapshotReader {
+public:
+    const char *pos;
+    const char *end;
+    bool ok;
+
+    SnapshotReader(const char *pos, const char *end) : pos(pos), end(end), ok(true) {}
+
+    void get(void *data, size_t size) {
+        if (!ok || (size_t) (end - pos) < size) {
+            ok = false;
+            memset(data, 0, size);
+            return;
+        }
+        memcpy(data, pos, size);
+        pos += size;
+    }
+
+    template <typename T> void operator()(std::vector<T>& table) {
+        uint64_t count;
+        uint32_t rowSize;
+        get(&count, sizeof count);
+        get(&rowSize, sizeof rowSize);
+        uint32_t expected = std::is_trivially_copyable<T>::value ? sizeof(T) : 0;
+        // Every row takes at least one byte, which bounds count before anything is allocated
+        if (!ok || rowSize != expected || count > (uint64_t) (end - pos)) {
+            ok = false;
+            return;
+        }
+        table.resize(count);
+        if constexpr (std::is_trivially_copyable<T>::value) {
+            get(table.data(), count * sizeof(T));
+        } else {
+            for (T& row : table) {
+                visit_fields(row, *this);
+            }
+        }
+    }
+};
+
+// Returns a complete snapshot of the loaded tables and pokedex indexes.
+std::string snapshotBytes() {
+    SnapshotWriter writer;
+    visit_tables(writer);
+
+    SnapshotHeader header;
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof header.magic);
+    header.version = SNAPSHOT_VERSION;
+    std::string paths;
+    for (int t = 0; t < NUM_POKEDEX_TABLES; t++) {
+        std::string path = findFilePath(pokedexTables[t]);
+        header.sources[t] = sourceOf(path);
+        header.sources[t].checksum = csvChecksum(path);
+        paths += path;
+        paths += '\0';
+    }
+    header.pathsSize = paths.size();
+    return std::string((const char *) &header, sizeof header) + paths + writer.bytes;
+}
+
+// Writes a snapshot of the loaded tables and pokedex indexes, replacing the file only once it is
+// complete. Returns false if it could not be written.
+bool writeSnapshot(const char *filename) {
+    std::string bytes = snapshotBytes();
+    std::string temporary = std::string(filename) + ".tmp";
+    std::ofstream out(temporary, std::ios::binary);
+    out.write(bytes.data(), bytes.size());
+    out.close();
+    if (!out || rename(temporary.c_str(), filename) != 0) {
+        remove(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+
+// Returns whether the name field of every row is an offset below poolSize.
+template <typename T>
+bool names_in_pool(const std::vector<T>& table, unsigned int T::*name, size_t poolSize) {
+    for (const T& row : table) {
+        if (row.*name >= poolSize) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Returns whether the CSVs are still the ones a snapshot was built from: each table must resolve to its
+// recorded path, so a CSV placed in a location searched earlier makes the snapshot stale, and the file
+// there must have the recorded checksum. A changed size or modification time rejects a file before it
+// is hashed.
+bool sourcesCurrent(const SnapshotHeader& header, const char *paths) {
+    const char *end = paths + header.pathsSize;
+    for (int t = 0; t < NUM_POKEDEX_TABLES; t++) {
+        const char *nul = (const char *) memchr(paths, '\0', end - paths);
+        if (nul == NULL) {
+            return false;
+        }
+        std::string path = findFilePath(pokedexTables[t]);
+        SnapshotSource source = sourceOf(path);
+        if (path != std::string(paths, nul) || source.size != header.sources[t].size ||
+            source.mtime != header.sources[t].mtime || csvChecksum(path) != header.sources[t].checksum) {
+            return false;
+        }
+        paths = nul + 1;
+    }
+    return paths == end;
+}
+
+// Loads the tables and pokedex indexes from snapshot bytes. Returns false, leaving the tables in an
+// unspecified state, if the bytes are malformed, from another SNAPSHOT_VERSION or, when checkSources
+// is set, built from CSVs that have changed since.
+bool loadSnapshotBytes(const char *data, size_t size, bool checkSources) {
+    if (size < sizeof(SnapshotHeader)) {
+        return false;
+    }
+    SnapshotHeader header;
+    memcpy(&header, data, sizeof header);
+    const char *paths = data + sizeof header;
+    if (memcmp(header.magic, SNAPSHOT_MAGIC, sizeof header.magic) != 0 || header.version != SNAPSHOT_VERSION ||
+        header.pathsSize > size - sizeof header || (checkSources && !sourcesCurrent(header, paths))) {
+        return false;
+    }
+
+    SnapshotReader reader(paths + header.pathsSize, data + size);
+    visit_tables(reader);
+    if (!reader.ok || reader.pos != reader.end) {
+        return false;
+    }
+
+    // Every identifier must start inside the pool, which must end in a NUL, for name_of to stay in bounds
+    identifiers.slots.clear();
+    identifiers.count = 0;
+    size_t poolSize = identifiers.chars.size();
+    return poolSize > 0 && identifiers.chars.back() == '\0' &&
+           names_in_pool(allPokemons, &Pokemon::identifier, poolSize) &&
+           names_in_pool(allMoves, &Move::identifier, poolSize) &&
+           names_in_pool(allPokemonSpecies, &PokemonSpecies::identifier, poolSize) &&
+           names_in_pool(allTypeNames, &TypeName::name, poolSize) &&
+           names_in_pool(allStats, &Stat::identifier, poolSize) &&
+           names_in_pool(allPokemonHabitats, &PokemonHabitat::identifier, poolSize);
+}
+
+// Loads a snapshot file with a single mmap; see loadSnapshotBytes.
+bool loadSnapshot(const char *filename) {
+    int fd = open(filename, O_RDONLY);
+    if (fd == -1) {
+        return false;
+    }
+    struct stat info;
+    void *mapped = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && info.st_size > 0) {
+        mapped = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        return false;
+    }
+    bool ok = loadSnapshotBytes((const char *) mapped, info.st_size, true);
+    munmap(mapped, info.st_size);
+    return ok;
+}
+
+#ifdef POKEDEX_EMBEDDED
+// Generated by make embedded: the pokedex snapshot as pokedexSnapshot, a string literal
+#include "pokedex_embedded.h"
+#endif
+
+// Loads every table: from the pokedex compiled into an embedded build, else from the snapshot when it
+// is present and current, else from the CSVs.
+void loadData() {
+#ifdef POKEDEX_EMBEDDED
+    if (loadSnapshotBytes(pokedexSnapshot, sizeof pokedexSnapshot - 1, false)) {
+        return;
+    }
+#endif
+    std::string snapshot = snapshotPath();
+    if (snapshot.empty() || !loadSnapshot(snapshot.c_str())) {
+        loadCsvData();
+    }
+}
+
+// Parses the CSVs and writes them as a C++ header holding the snapshot bytes in one string literal, for
+// compiling into the binary with -DPOKEDEX_EMBEDDED (./Poke --build-embedded <header> [csv dir]).
+int buildEmbedded(const char *filename) {
+    loadCsvData();
+    if (allPokemons.empty()) {
+        std::cerr << "Error: Pokedex CSV files not found." << std::endl;
+        return 1;
+    }
+
+    std::string bytes = snapshotBytes();
+    std::ofstream out(filename, std::ios::binary);
+    out << "// Generated by ./Poke --build-embedded from the pokedex CSVs; do not edit.\n";
+    out << "constexpr char pokedexSnapshot[] =\n";
+    char escaped[8];
+    std::string line;
+    for (size_t i = 0; i < bytes.size(); i++) {
+        unsigned char c = bytes[i];
+        if (c >= ' ' && c <= '~' && c != '"' && c != '\\' && c != '?') {
+            line += (char) c;
+        } else {
+            snprintf(escaped, sizeof escaped, "\\%03o", c); // Fixed width, so a following digit stays separate
+            line += escaped;
+        }
+        if (line.size() >= 120 || i + 1 == bytes.size()) {
+            out << "    \"" << line << "\"\n";
+            line.clear();
+        }
+    }
+    out << "    \"\";\n";
+    out.close();
+    if (!out) {
+        std::cerr << "Error: Could not write " << filename << "." << std::endl;
+        return 1;
+    }
+    std::cout << "Wrote " << filename << std::endl;
+    return 0;
+}
+
+// Parses the CSVs and writes them to a snapshot for later runs (./Poke --build-snapshot [file]). Without
+// a file, the snapshot goes next to the CSVs.
+int buildSnapshot(const char *filename) {
+    loadCsvData();
+    if (allPokemons.empty()) {
+        std::cerr << "Error: Pokedex CSV files not found." << std::endl;
+        return 1;
+    }
+    std::string path = filename != NULL ? filename : defaultSnapshotPath();
+    if (!writeSnapshot(path.c_str())) {
+        std::cerr << "Error: Could not write " << path << "." << std::endl;
+        return 1;
+    }
+    std::cout << "Wrote " << path << std::endl;
+    return 0;
+}
+
+class PriorityQueueNode {
+public:
+    int x;
+    int y;
+    int layer; // Pathing layer the cell belongs to
+    int cost;
+
+    PriorityQueueNode() : x(0), y(0), layer(0), cost(0) {}  // Default constructor
+
+    // You can also add a constructor for initialization
+    PriorityQueueNode(int x, int y, int layer, int cost) : x(x), y(y), layer(layer), cost(cost) {}
+};
+
+// Indexed binary min-heap over (pathing layer, cell) nodes. pos[layer][y][x] holds the heap slot
+// of each queued node (-1 when it is not queued) so a node's cost can be lowered in O(log n).
+class PriorityQueue {
+public:
+    PriorityQueueNode heap[NUM_PATHING_TYPES * HEIGHT * WIDTH];
+    int pos[NUM_PATHING_TYPES][HEIGHT][WIDTH];
+    int size;
+
+    PriorityQueue() : size(0) {
+        for (int l = 0; l < NUM_PATHING_TYPES; ++l) {
+            for (int i = 0; i < HEIGHT; ++i) {
+                for (int j = 0; j < WIDTH; ++j) {
+                    pos[l][i][j] = -1;
+                }
+            }
+        }
+    }
+};
+
+// Distance maps to the PC for every pathing trainer type, one contiguous plane per type,
+// cached on a terrain map together with the PC position they were computed from.
+class DistanceMaps {
+public:
+    int dist[NUM_PATHING_TYPES][HEIGHT][WIDTH];
+    int srcX, srcY; // -1 until the maps have been computed
+
+    DistanceMaps() : srcX(-1), srcY(-1) {}
+};
+
+// A map's trainers as parallel arrays: trainer i is entry i of every array, and map::occupant
+// refers to trainers by that index. Movement only streams through the position, direction, type
+// and defeated arrays; teams are only touched by battles.
+class NPCStore {
+public:
+    std::pmr::vector<short> x, y;
+    std::pmr::vector<signed char> dx, dy; // Walking direction of pacers, wanderers and explorers
+    std::pmr::vector<int> cost;           // Total movement cost spent so far, which is also the time of its next turn
+    std::pmr::vector<char> type;          // 'h' for hiker, 'r' for rival, etc.
+    std::pmr::vector<bool> defeated;
+    std::pmr::vector<PokemonWithMoves> pokemons; // Every trainer's team, back to back in trainer order
+    std::pmr::vector<int> teamStart;             // Index in pokemons of each trainer's first Pokemon
+    std::pmr::vector<unsigned char> teamSize;
+
+    // Keeps every array in arena, which must outlive the store.
+    NPCStore(std::pmr::memory_resource *arena)
+        : x(arena), y(arena), dx(arena), dy(arena), cost(arena), type(arena), defeated(arena), pokemons(arena),
+          teamStart(arena), teamSize(arena) {}
+
+    int size() const {
+        return (int) type.size();
+    }
+
+    // Makes room for trainers trainers with full teams, so adding them allocates nothing more.
+    void reserve(int trainers) {
+        x.reserve(trainers);
+        y.reserve(trainers);
+        dx.reserve(trainers);
+        dy.reserve(trainers);
+        cost.reserve(trainers);
+        type.reserve(trainers);
+        defeated.reserve(trainers);
+        pokemons.reserve(trainers * MAX_TEAM_SIZE);
+        teamStart.reserve(trainers);
+        teamSize.reserve(trainers);
+    }
+
+    // Appends a trainer and returns its index.
+    int add(int newX, int newY, char newType, int newDx, int newDy) {
+        x.push_back(newX);
+        y.push_back(newY);
+        dx.push_back(newDx);
+        dy.push_back(newDy);
+        cost.push_back(0);
+        type.push_back(newType);
+        defeated.push_back(false);
+        teamStart.push_back(pokemons.size());
+        teamSize.push_back(0);
+        return size() - 1;
+    }
+
+    // Adds a Pokemon to a trainer's team. Only the last trainer added can take more, which keeps every
+    // team contiguous.
+    void addPokemon(int id, const PokemonWithMoves& pokemon) {
+        assert(id == size() - 1);
+        pokemons.push_back(pokemon);
+        teamSize[id]++;
+    }
+
+    // Returns a trainer's team, valid until the next trainer or Pokemon is added.
+    Team team(int id) {
+        Team team;
+        team.first = pokemons.data() + teamStart[id];
+        team.count = teamSize[id];
+        return team;
+    }
+};
+
+// One pending turn on a map's clock. actor is an index in npcs, or PC_OCCUPANT for the PC; seq breaks
+// ties in the order turns were queued, so equal-time turns always run in the same order.
+class TurnEvent {
+public:
+    int time;
+    int seq;
+    short actor;
+
+    TurnEvent() : time(0), seq(0), actor(0) {}
+    TurnEvent(int time, int seq, short actor) : time(time), seq(seq), actor(actor) {}
+};
+
+// A map's turn order: a min-heap of pending turns keyed on (time, seq). Sentries are never queued and
+// defeated trainers are dropped when their turn comes up. The PC's turn is found by sequence number,
+// so turns it left behind when it last walked off the map are skipped.
+class TurnQueue {
+public:
+    std::pmr::vector<TurnEvent> heap;
+    int now;     // Time of the most recent turn taken on this map
+    int nextSeq;
+    int pcSeq;   // seq of the PC's pending turn, PC_ACTING during its turn, -1 while it is elsewhere
+
+    TurnQueue(std::pmr::memory_resource *arena) : heap(arena), now(0), nextSeq(0), pcSeq(-1) {}
+};
+
+// Checks if turn a comes before turn b.
+bool turn_before(const TurnEvent &a, const TurnEvent &b)
+{
+    return a.time != b.time ? a.time < b.time : a.seq < b.seq;
+}
+
+// Adds a turn to the queue.
+void turn_push(TurnQueue *turns, const TurnEvent &turn)
+{
+    turns->heap.push_back(turn);
+    TurnEvent *heap = turns->heap.data();
+    int i = (int) turns->heap.size() - 1;
+    while (i > 0)
+    {
+        int parent = (i - 1) / 2;
+        if (!turn_before(turn, heap[parent]))
+        {
+            break;
+        }
+        heap[i] = heap[parent];
+        i = parent;
+    }
+    heap[i] = turn;
+}
+
+// Removes and returns the earliest turn in the queue.
+TurnEvent turn_pop(TurnQueue *turns)
+{
+    TurnEvent *heap = turns->heap.data();
+    TurnEvent first = heap[0];
+    TurnEvent last = turns->heap.back();
+    turns->heap.pop_back();
+    int size = (int) turns->heap.size();
+    if (size > 0)
+    {
+        int i = 0;
+        while (true)
+        {
+            int child = 2 * i + 1;
+            if (child >= size)
+            {
+                break;
+            }
+            if (child + 1 < size && turn_before(heap[child + 1], heap[child]))
+            {
+                child++;
+            }
+            if (!turn_before(heap[child], last))
+            {
+                break;
+            }
+            heap[i] = heap[child];
+            i = child;
+        }
+        heap[i] = last;
+    }
+    return first;
+}
+
+// Arena bytes for the NPCStore and TurnQueue of a map with trainers trainers, with some slack for
+// alignment.
+size_t map_arena_bytes(int trainers) {
+    size_t perTrainer = 2 * sizeof(short) + 2 * sizeof(signed char) + sizeof(int) + sizeof(char) + 1 +
+                        MAX_TEAM_SIZE * sizeof(PokemonWithMoves) + sizeof(int) + sizeof(unsigned char) +
+                        sizeof(TurnEvent);
+    return 512 + trainers * perTrainer;
+}
+
+// Everything the game keeps for one map of the world: the terrain, who stands where on it,
+// the cached pathing data, and the map's trainers.
+class map {
+public:
+    char board[HEIGHT][WIDTH];    // Represents the game board (terrain only; trainers and the PC are tracked below)
+    int North, East, South, West; // Represents the positions of the paths (roads)
+    int VB, HB;
+    short occupant[HEIGHT][WIDTH];        // Index in npcs of the trainer on each cell, PC_OCCUPANT or NO_OCCUPANT
+    int pcX, pcY;                         // PC position on this map, -1 while the PC is elsewhere
+    // Movement cost of entering each cell, per cost layer. The board is fixed once generateMap
+    // finishes, so anything editing it later must clear costs_valid.
+    short cost[NUM_COST_LAYERS][HEIGHT][WIDTH];
+    bool costs_valid;
+    DistanceMaps *distances; // Cached distance maps to the PC, allocated on first use
+    // Backs the trainer and turn arrays below. They reserve room for the map's trainers up front, so a
+    // map takes a handful of allocations and its arrays are released together when it is deleted.
+    std::pmr::monotonic_buffer_resource arena;
+    NPCStore npcs;           // The map's trainers, placed by generateMap
+    TurnQueue turns;         // Who moves next on this map
+
+    map(int trainers) : arena(map_arena_bytes(trainers)), npcs(&arena), turns(&arena) {
+        npcs.reserve(trainers);
+        turns.heap.reserve(trainers + 2); // Everyone's next turn plus the PC's, and one stale PC turn
+        // Initialize the board and directions, if needed
+        for (int i = 0; i < HEIGHT; ++i) {
+            for (int j = 0; j < WIDTH; ++j) {
+                board[i][j] = ' '; // Assuming ' ' is your default empty cell
+                occupant[i][j] = NO_OCCUPANT;
+            }
+        }
+        North = East = South = West = -1; // Assuming -1 means uninitialized or no path
+        VB = HB = -1;
+        pcX = pcY = -1;
+        costs_valid = false;
+        distances = NULL;
+    }
+
+    ~map() {
+        delete distances;
+    }
+};
+
+// Checks if a trainer or the PC stands at (x, y).
+bool is_occupied(map *m, int x, int y)
+{
+    return m->occupant[y][x] != NO_OCCUPANT;
+}
+
+// Returns the index of the trainer standing at (x, y), or -1 if the cell is empty or holds the PC.
+int trainer_at(map *m, int x, int y)
+{
+    return m->occupant[y][x] >= 0 ? m->occupant[y][x] : -1;
+}
+
+// Queues a turn for actor at time on the map and returns its sequence number.
+int schedule_turn(map *m, int time, int actor)
+{
+    TurnQueue &turns = m->turns;
+    turn_push(&turns, TurnEvent(time, turns.nextSeq, actor));
+    return turns.nextSeq++;
+}
+
+// Puts the PC at (x, y), leaving the cell it stood on if it was already on this map. A PC arriving
+// from elsewhere gets its first turn at the map's current time.
+void place_pc(map *m, int x, int y)
+{
+    if (m->pcX != -1)
+    {
+        m->occupant[m->pcY][m->pcX] = NO_OCCUPANT;
+    }
+    else
+    {
+        m->turns.pcSeq = schedule_turn(m, m->turns.now, PC_OCCUPANT);
     }
+    m->pcX = x;
+    m->pcY = y;
+    m->occupant[y][x] = PC_OCCUPANT;
+}
 
-    return stats;
+// Takes the PC off the map when it leaves through a gate or flies away.
+void remove_pc(map *m)
+{
+    if (m->pcX != -1)
+    {
+        m->occupant[m->pcY][m->pcX] = NO_OCCUPANT;
+    }
+    m->pcX = m->pcY = -1;
+    m->turns.pcSeq = -1;
 }
 
-std::vector<PokemonType> parsePokemonTypesCSV(const std::string& filename) {
-    std::vector<PokemonType> pokemonTypes;
-    std::ifstream file(filename);
-    std::string line;
-    std::getline(file, line); // Skip the header line
+#ifndef NDEBUG
+// Checks that the PC position recorded on its map and the trainer positions agree with the occupant
+// index: the PC and every trainer are found on their own cells, and no other cell is occupied.
+bool pc_position_consistent(map *m)
+{
+    if (m->pcX < 0 || m->pcX >= WIDTH || m->pcY < 0 || m->pcY >= HEIGHT || m->occupant[m->pcY][m->pcX] != PC_OCCUPANT)
+    {
+        return false;
+    }
+    for (int i = 0; i < m->npcs.size(); i++)
+    {
+        if (m->occupant[m->npcs.y[i]][m->npcs.x[i]] != i)
+        {
+            return false;
+        }
+    }
+    int occupied = 0;
+    for (int i = 0; i < HEIGHT; i++)
+    {
+        for (int j = 0; j < WIDTH; j++)
+        {
+            occupied += is_occupied(m, j, i);
+        }
+    }
+    return occupied == m->npcs.size() + 1;
+}
+#endif
 
-    while (std::getline(file, line)) {
-        std::stringstream linestream(line);
-        std::string cell;
-        PokemonType pokemonType;
+PokemonWithMoves generateRandomPokemonWithMoves(int curX, int curY, int habitatId);
 
-        std::getline(linestream, cell, ',');
-        pokemonType.pokemon_id = cell.empty() ? INT_MAX : std::stoi(cell);
+// Directions trainers can step in, as (npc_dx[d], npc_dy[d])
+const int npc_dx[8] = {-1, -1, -1, 0, 1, 1, 1, 0};
+const int npc_dy[8] = {-1, 0, 1, 1, 1, 0, -1, -1};
 
-        std::getline(linestream, cell, ',');
-        pokemonType.type_id = cell.empty() ? INT_MAX : std::stoi(cell);
+// Adds a trainer of the given type at (x, y) on the map at world coordinates (mapX, mapY), with a
+// team of Pokemon suited to the habitat it stands in. Walking trainers start in a random direction, and
+// everyone but sentries gets a turn at the map's current time.
+void add_trainer(map *m, int x, int y, char type, int mapX, int mapY)
+{
+    int direction = (type == PACER || type == WANDERER || type == EXPLORER) ? next_random(RNG_WORLD) % 8 : 0;
+    int id = m->npcs.add(x, y, type, npc_dx[direction], npc_dy[direction]);
+    if (type != SENTRY) {
+        m->npcs.cost[id] = m->turns.now;
+        schedule_turn(m, m->turns.now, id);
+    }
 
-        std::getline(linestream, cell, ',');
-        pokemonType.slot = cell.empty() ? INT_MAX : std::stoi(cell);
+    int habitatId = -1;  // Default value indicating no specific habitat is set
+    if (m->board[y][x] == GRASS || m->board[y][x] == TALL_GRASS) {
+        habitatId = 3;  // Grassland
+    } else if (m->board[y][x] == TREE) {
+        habitatId = 2;  // Forest
+    }
 
-        pokemonTypes.push_back(pokemonType);
+    // Generate Pokémon for this NPC
+    int numPokemons = 1 + (next_random(RNG_TRAINERS) % MAX_TEAM_SIZE); // Each NPC has 1 to 6 Pokémon
+    for (int k = 0; k < numPokemons; k++) {
+        m->npcs.addPokemon(id, generateRandomPokemonWithMoves(mapX, mapY, habitatId));
     }
 
-    return pokemonTypes;
+    m->occupant[y][x] = id;
 }
 
-std::vector<PokemonHabitat> parsePokemonHabitatsCSV(const std::string& filename) {
-    std::vector<PokemonHabitat> pokemonHabitats;
-    std::ifstream file(filename);
-    std::string line;
-    std::getline(file, line); // Skip the header line
-
-    while (std::getline(file, line)) {
-        std::stringstream linestream(line);
-        std::string cell;
-        PokemonHabitat habitat;
+// A CHUNK_SIZE x CHUNK_SIZE block of neighboring maps.
+class WorldChunk {
+public:
+    map *maps[CHUNK_SIZE][CHUNK_SIZE];
 
-        std::getline(linestream, cell, ',');
-        habitat.id = cell.empty() ? INT_MAX : std::stoi(cell);
+    WorldChunk() {
+        for (int i = 0; i < CHUNK_SIZE; ++i) {
+            for (int j = 0; j < CHUNK_SIZE; ++j) {
+                maps[i][j] = NULL;
+            }
+        }
+    }
+};
 
-        std::getline(linestream, habitat.identifier, ',');
+WorldChunk *worldChunks[NUM_CHUNKS][NUM_CHUNKS]; // Represents the world; NULL until a map in the chunk is generated
 
-        pokemonHabitats.push_back(habitat);
+// Returns the map at world coordinates (x, y), or NULL if it is outside the world or not generated yet.
+map *get_map(int x, int y)
+{
+    if (x < 0 || x >= MAP_SIZE || y < 0 || y >= MAP_SIZE)
+    {
+        return NULL;
     }
-
-    return pokemonHabitats;
+    WorldChunk *chunk = worldChunks[y / CHUNK_SIZE][x / CHUNK_SIZE];
+    return chunk == NULL ? NULL : chunk->maps[y % CHUNK_SIZE][x % CHUNK_SIZE];
 }
 
-bool fileExists(const std::string& filePath) {
-    std::ifstream file(filePath);
-    return file.good();
+// Allocates the map at world coordinates (x, y), with room for trainers trainers, and its chunk if this
+// is the chunk's first map.
+map *new_map(int x, int y, int trainers)
+{
+    WorldChunk *&chunk = worldChunks[y / CHUNK_SIZE][x / CHUNK_SIZE];
+    if (chunk == NULL)
+    {
+        chunk = new WorldChunk;
+    }
+    map *&slot = chunk->maps[y % CHUNK_SIZE][x % CHUNK_SIZE];
+    slot = new map(trainers);
+    return slot;
 }
 
-// Declare global variables
-std::vector<Pokemon> allPokemons;
-std::vector<Move> allMoves;
-std::vector<PokemonMove> allPokemonMoves;
-std::vector<PokemonSpecies> allPokemonSpecies;
-std::vector<Experience> allExperiences;
-std::vector<TypeName> allTypeNames;
-std::vector<PokemonStat> allPokemonStats;
-std::vector<Stat> allStats;
-std::vector<PokemonType> allPokemonTypes;
-std::vector<PokemonHabitat> allPokemonHabitats;
-
-std::string findFilePath(const std::string& fileType) {
-    std::string filePath;
-
-    // Try the first location
-    filePath = "/share/Pokemon-Text-Based-Game/pokedex/pokedex/data/csv/" + fileType + ".csv";
-    if (fileExists(filePath)) {
-        return filePath;
+// Frees every generated map.
+void free_world()
+{
+    for (int cy = 0; cy < NUM_CHUNKS; cy++) {
+        for (int cx = 0; cx < NUM_CHUNKS; cx++) {
+            WorldChunk *chunk = worldChunks[cy][cx];
+            if (chunk == NULL) {
+                continue;
+            }
+            for (int i = 0; i < CHUNK_SIZE; i++) {
+                for (int j = 0; j < CHUNK_SIZE; j++) {
+                    delete chunk->maps[i][j];
+                }
+            }
+            delete chunk;
+            worldChunks[cy][cx] = NULL;
+        }
     }
+}
 
-    // Try the second location
-    const char* homeDir = getenv("HOME");
-    if (homeDir != nullptr) {
-        filePath = std::string(homeDir) + "/.poke327/pokedex/pokedex/data/csv/" + fileType + ".csv";
-        if (fileExists(filePath)) {
-            return filePath;
+// Swaps two heap slots and keeps the position index in sync.
+void pq_swap(PriorityQueue *pq, int i, int j)
+{
+    PriorityQueueNode tmp = pq->heap[i];
+    pq->heap[i] = pq->heap[j];
+    pq->heap[j] = tmp;
+    pq->pos[pq->heap[i].layer][pq->heap[i].y][pq->heap[i].x] = i;
+    pq->pos[pq->heap[j].layer][pq->heap[j].y][pq->heap[j].x] = j;
+}
+
+// Moves the node at slot i up until its parent is no more expensive.
+void pq_sift_up(PriorityQueue *pq, int i)
+{
+    while (i > 0)
+    {
+        int parent = (i - 1) / 2;
+        if (pq->heap[parent].cost <= pq->heap[i].cost)
+        {
+            break;
         }
+        pq_swap(pq, i, parent);
+        i = parent;
     }
+}
 
-    // Try the third location
-    filePath = "c:/Pokemon-Text-Based-Game/pokedex/pokedex/data/csv/" + fileType + ".csv";
-    if (fileExists(filePath)) {
-        return filePath;
+// Moves the node at slot i down until both children are no cheaper.
+void pq_sift_down(PriorityQueue *pq, int i)
+{
+    while (true)
+    {
+        int smallest = i;
+        int left = 2 * i + 1;
+        int right = left + 1;
+        if (left < pq->size && pq->heap[left].cost < pq->heap[smallest].cost)
+        {
+            smallest = left;
+        }
+        if (right < pq->size && pq->heap[right].cost < pq->heap[smallest].cost)
+        {
+            smallest = right;
+        }
+        if (smallest == i)
+        {
+            break;
+        }
+        pq_swap(pq, i, smallest);
+        i = smallest;
     }
-
-    // If the file is not found in any location, return an empty string
-    return "";
 }
 
-void loadData() {
-    allPokemons = parsePokemonCSV(findFilePath("pokemon"));
-    allMoves = parseMovesCSV(findFilePath("moves"));
-    allPokemonMoves = parsePokemonMovesCSV(findFilePath("pokemon_moves"));
-    allPokemonSpecies = parsePokemonSpeciesCSV(findFilePath("pokemon_species"));
-    allExperiences = parseExperienceCSV(findFilePath("experience"));
-    allTypeNames = parseTypeNamesCSV(findFilePath("type_names"));
-    allPokemonStats = parsePokemonStatsCSV(findFilePath("pokemon_stats"));
-    allStats = parseStatsCSV(findFilePath("stats"));
-    allPokemonTypes = parsePokemonTypesCSV(findFilePath("pokemon_types"));
-    allPokemonHabitats = parsePokemonHabitatsCSV(findFilePath("pokemon_habitats"));
+// Adds a new node with given coordinates and cost to the priority queue.
+void pq_add(PriorityQueue *pq, int x, int y, int layer, int cost)
+{
+    int i = pq->size++;
+    pq->heap[i] = PriorityQueueNode(x, y, layer, cost);
+    pq->pos[layer][y][x] = i;
+    pq_sift_up(pq, i);
 }
 
-class PriorityQueueNode {
-public:
-    int x;
-    int y;
-    int cost;
-
-    PriorityQueueNode() : x(0), y(0), cost(0) {}  // Default constructor
+// Extracts and returns the node with the minimum cost from the priority queue.
+PriorityQueueNode pq_extract_min(PriorityQueue *pq)
+{
+    PriorityQueueNode minNode = pq->heap[0];
+    pq->size--;
+    if (pq->size > 0)
+    {
+        pq_swap(pq, 0, pq->size);
+        pq_sift_down(pq, 0);
+    }
+    pq->pos[minNode.layer][minNode.y][minNode.x] = -1;
+    return minNode;
+}
 
-    // You can also add a constructor for initialization
-    PriorityQueueNode(int x, int y, int cost) : x(x), y(y), cost(cost) {}
-};
+// Updates the cost of a node in the priority queue if the new cost is lower, queueing it if absent.
+void pq_update_priority(PriorityQueue *pq, int x, int y, int layer, int new_cost)
+{
+    int i = pq->pos[layer][y][x];
+    if (i == -1)
+    {
+        pq_add(pq, x, y, layer, new_cost);
+    }
+    else if (pq->heap[i].cost > new_cost)
+    {
+        pq->heap[i].cost = new_cost;
+        pq_sift_up(pq, i);
+    }
+}
 
-class map {
+// Monotone bucket queue (Dial's algorithm) for small integer costs that are all multiples of Step.
+// Dijkstra only ever queues costs within MaxCost of the last extracted one, so MaxCost / Step + 1
+// circular buckets each hold a single cost value. Buckets are intrusive doubly linked lists over
+// (layer, cell) node ids, so insertion and decrease-key are O(1) and extraction scans at most
+// NUM_BUCKETS buckets.
+template <int MaxCost, int Step>
+class BucketQueue {
 public:
-    char board[HEIGHT][WIDTH];    // Represents the game board
-    int North, East, South, West; // Represents the positions of the paths (roads)
-    int VB, HB;
-
-    map() {
-        // Initialize the board and directions, if needed
-        for (int i = 0; i < HEIGHT; ++i) {
-            for (int j = 0; j < WIDTH; ++j) {
-                board[i][j] = ' '; // Assuming ' ' is your default empty cell
-            }
+    static const int NUM_BUCKETS = MaxCost / Step + 1;
+    static const int NUM_NODES = NUM_PATHING_TYPES * HEIGHT * WIDTH;
+    int head[NUM_BUCKETS];
+    int next[NUM_NODES];
+    int prev[NUM_NODES];
+    int cost[NUM_NODES]; // -1 when the node is not queued
+    int current;         // Bucket holding the smallest queued cost
+    int size;
+
+    BucketQueue() : current(0), size(0) {
+        for (int i = 0; i < NUM_BUCKETS; ++i) {
+            head[i] = -1;
+        }
+        for (int i = 0; i < NUM_NODES; ++i) {
+            cost[i] = -1;
         }
-        North = East = South = West = -1; // Assuming -1 means uninitialized or no path
-        VB = HB = -1;
     }
 };
 
-class NPC {
-public:
-    int x;
-    int y;
-    int cost;
-    int dx;  // Direction in the x-axis
-    int dy;  // Direction in the y-axis
-    char type; // 'h' for hiker, 'r' for rival, etc.
-    bool is_direction_initialized; // Flag to indicate if the direction is initialized
-    bool is_defeated;
-    std::vector<PokemonWithMoves> pokemons;
-
-    // Default constructor
-    NPC() : x(0), y(0), cost(0), dx(0), dy(0), type(' '), is_direction_initialized(false), is_defeated(false) {}
-
-    // Parameterized constructor
-    NPC(int x, int y, int cost, int dx, int dy, char type, bool is_direction_initialized, bool is_defeated)
-        : x(x), y(y), cost(cost), dx(dx), dy(dy), type(type), is_direction_initialized(is_direction_initialized), is_defeated(is_defeated) {}
-};
-
-map *worldMap[MAP_SIZE][MAP_SIZE]; // Represents the world map as a 2D array of pointers to maps
-map *firstLayer[MAP_SIZE][MAP_SIZE];
+// Node id of a (layer, cell) pair in a BucketQueue.
+inline int bq_node(int x, int y, int layer)
+{
+    return (layer * HEIGHT + y) * WIDTH + x;
+}
 
-// Adds a new node with given coordinates and cost to the priority queue.
-void pq_add(PriorityQueueNode pq[], int *pq_size, int x, int y, int cost)
+// Pushes a node onto the front of the bucket for its cost.
+template <int MaxCost, int Step>
+void bq_link(BucketQueue<MaxCost, Step> *pq, int node, int cost)
 {
-    pq[*pq_size] = (PriorityQueueNode){x, y, cost};
-    (*pq_size)++;
+    int bucket = (cost / Step) % BucketQueue<MaxCost, Step>::NUM_BUCKETS;
+    pq->cost[node] = cost;
+    pq->prev[node] = -1;
+    pq->next[node] = pq->head[bucket];
+    if (pq->head[bucket] != -1)
+    {
+        pq->prev[pq->head[bucket]] = node;
+    }
+    pq->head[bucket] = node;
 }
 
-// Extracts and returns the node with the minimum cost from the priority queue.
-PriorityQueueNode pq_extract_min(PriorityQueueNode pq[], int *pq_size)
+// Removes a queued node from its bucket.
+template <int MaxCost, int Step>
+void bq_unlink(BucketQueue<MaxCost, Step> *pq, int node)
 {
-    int minIndex = 0;
-    for (int i = 1; i < *pq_size; i++)
+    int bucket = (pq->cost[node] / Step) % BucketQueue<MaxCost, Step>::NUM_BUCKETS;
+    if (pq->prev[node] != -1)
     {
-        if (pq[i].cost < pq[minIndex].cost)
-        {
-            minIndex = i;
-        }
+        pq->next[pq->prev[node]] = pq->next[node];
     }
-    PriorityQueueNode minNode = pq[minIndex];
-    for (int i = minIndex; i < *pq_size - 1; i++)
+    else
     {
-        pq[i] = pq[i + 1];
+        pq->head[bucket] = pq->next[node];
     }
-    (*pq_size)--;
-    return minNode;
+    if (pq->next[node] != -1)
+    {
+        pq->prev[pq->next[node]] = pq->prev[node];
+    }
+}
+
+// Adds a new node with given coordinates and cost to the bucket queue.
+template <int MaxCost, int Step>
+void pq_add(BucketQueue<MaxCost, Step> *pq, int x, int y, int layer, int cost)
+{
+    bq_link(pq, bq_node(x, y, layer), cost);
+    pq->size++;
 }
 
-// Updates the cost of a node in the priority queue if the new cost is lower.
-void pq_update_priority(PriorityQueueNode pq[], int pq_size, int x, int y, int new_cost)
+// Extracts and returns the node with the minimum cost from the bucket queue.
+template <int MaxCost, int Step>
+PriorityQueueNode pq_extract_min(BucketQueue<MaxCost, Step> *pq)
 {
-    for (int i = 0; i < pq_size; i++)
+    while (pq->head[pq->current] == -1)
     {
-        if (pq[i].x == x && pq[i].y == y && pq[i].cost > new_cost)
-        {
-            pq[i].cost = new_cost;
-            break;
-        }
+        pq->current = (pq->current + 1) % BucketQueue<MaxCost, Step>::NUM_BUCKETS;
     }
+    int node = pq->head[pq->current];
+    int cost = pq->cost[node];
+    bq_unlink(pq, node);
+    pq->cost[node] = -1;
+    pq->size--;
+    return PriorityQueueNode(node % WIDTH, (node / WIDTH) % HEIGHT, node / (HEIGHT * WIDTH), cost);
 }
 
+// Updates the cost of a node in the bucket queue if the new cost is lower, queueing it if absent.
+template <int MaxCost, int Step>
+void pq_update_priority(BucketQueue<MaxCost, Step> *pq, int x, int y, int layer, int new_cost)
+{
+    int node = bq_node(x, y, layer);
+    if (pq->cost[node] == -1)
+    {
+        pq_add(pq, x, y, layer, new_cost);
+    }
+    else if (pq->cost[node] > new_cost)
+    {
+        bq_unlink(pq, node);
+        bq_link(pq, node, new_cost);
+    }
+}
+
+// Greatest common divisor of a list of costs.
+constexpr int costs_gcd(int a)
+{
+    return a;
+}
+
+template <class... Rest>
+constexpr int costs_gcd(int a, int b, Rest... rest)
+{
+    return costs_gcd(std::gcd(a, b), rest...);
+}
+
+// Compile-time set of the finite movement costs a board can contain.
+template <int... Costs>
+class CostSet {
+public:
+    static constexpr int max_cost = std::max({Costs...});
+    static constexpr int step = costs_gcd(Costs...); // Every path cost is a multiple of this
+
+    static constexpr bool contains(int cost) {
+        return ((cost == Costs) || ...);
+    }
+};
+
+// Finite costs returned by get_movement_cost; everything else is SHRT_MAX (impassable).
+typedef CostSet<10, 15, 20, 50> TerrainCosts;
+
+// Cost sets needing at most this many buckets get Dial's bucket queue, others the binary heap.
+#define MAX_DIAL_BUCKETS 64
+
+// Picks the priority queue Dijkstra uses for a cost set at compile time.
+template <class Costs>
+class QueueFor {
+public:
+    typedef typename std::conditional<(Costs::max_cost / Costs::step + 1 <= MAX_DIAL_BUCKETS),
+                                      BucketQueue<Costs::max_cost, Costs::step>,
+                                      PriorityQueue>::type type;
+};
+
 // Checks if a given cell at (x, y) is part of a forest by counting adjacent trees.
-int is_forest(map *worldMap, int x, int y)
+int is_forest(char board[HEIGHT][WIDTH], int x, int y)
 {
     int treeCount = 0;
     for (int dy = -1; dy <= 1; dy++)
@@ -718,7 +2415,7 @@ int is_forest(map *worldMap, int x, int y)
                 continue;
             int newX = x + dx;
             int newY = y + dy;
-            if (newX >= 0 && newX < WIDTH && newY >= 0 && newY < HEIGHT && worldMap->board[newY][newX] == TREE)
+            if (newX >= 0 && newX < WIDTH && newY >= 0 && newY < HEIGHT && board[newY][newX] == TREE)
             {
                 treeCount++;
             }
@@ -728,18 +2425,18 @@ int is_forest(map *worldMap, int x, int y)
 }
 
 // Checks if a given path at (x, y) is a gate by being adjacent to two borders.
-int is_gate(map *worldMap, int x, int y)
+int is_gate(char board[HEIGHT][WIDTH], int x, int y)
 {
-    if (worldMap->board[y][x] != PATH)
+    if (board[y][x] != PATH)
     {
         return 0; // Not a path, so not a gate
     }
 
     // Check if the path is between two borders
-    if ((x == 0 && worldMap->board[y + 1][x] == BORDER && worldMap->board[y - 1][x] == BORDER) ||
-        (x == WIDTH - 1 && worldMap->board[y + 1][x] == BORDER && worldMap->board[y - 1][x] == BORDER) ||
-        (y == 0 && worldMap->board[y][x + 1] == BORDER && worldMap->board[y][x - 1] == BORDER) ||
-        (y == HEIGHT - 1 && worldMap->board[y][x + 1] == BORDER && worldMap->board[y][x - 1] == BORDER))
+    if ((x == 0 && board[y + 1][x] == BORDER && board[y - 1][x] == BORDER) ||
+        (x == WIDTH - 1 && board[y + 1][x] == BORDER && board[y - 1][x] == BORDER) ||
+        (y == 0 && board[y][x + 1] == BORDER && board[y][x - 1] == BORDER) ||
+        (y == HEIGHT - 1 && board[y][x + 1] == BORDER && board[y][x - 1] == BORDER))
     {
         return 1; // It's a gate
     }
@@ -748,15 +2445,15 @@ int is_gate(map *worldMap, int x, int y)
 }
 
 // Calculates the movement cost for a trainer type at a given cell (x, y) based on terrain.
-int get_movement_cost(map *worldMap, int x, int y, char trainer_type)
+int get_movement_cost(map *m, int x, int y, char trainer_type)
 {
-    char terrain = worldMap->board[y][x];
+    char terrain = m->board[y][x];
     switch (terrain)
     {
     case BORDER:
         return SHRT_MAX; // Impassable for all trainers
     case TREE:
-        if (is_forest(worldMap, x, y))
+        if (is_forest(m->board, x, y))
         {
             if (trainer_type == HIKER)
             {
@@ -774,7 +2471,7 @@ int get_movement_cost(map *worldMap, int x, int y, char trainer_type)
     case WATER:
         return SHRT_MAX; // Impassable for all trainers except Swimmers
     case PATH:
-        if (is_gate(worldMap, x, y) && trainer_type != PC)
+        if (is_gate(m->board, x, y) && trainer_type != PC)
         {
             return SHRT_MAX; // Gates are impassable for NPCs, only PC can pass the gate
         }
@@ -816,27 +2513,77 @@ int get_movement_cost(map *worldMap, int x, int y, char trainer_type)
     }
 }
 
-// Implements Dijkstra's algorithm using a priority queue to find the shortest paths from (srcX, srcY).
-void dijkstra_with_priority_queue(map *worldMap, int srcX, int srcY, int dist[HEIGHT][WIDTH], char trainer_type)
+// Maps a trainer type to the cost layer holding its movement costs.
+int cost_layer(char trainer_type)
 {
-    PriorityQueueNode pq[HEIGHT * WIDTH];
-    int pq_size = 0;
+    switch (trainer_type)
+    {
+    case PC:
+        return COST_PC;
+    case HIKER:
+        return COST_HIKER;
+    case RIVAL:
+        return COST_RIVAL;
+    default:
+        return COST_OTHER;
+    }
+}
 
-    for (int y = 0; y < HEIGHT; y++)
+// Returns the cached cost grid of a map's terrain for a trainer type, building all layers on first use.
+short (*movement_costs(map *terrain, char trainer_type))[WIDTH]
+{
+    if (!terrain->costs_valid)
     {
-        for (int x = 0; x < WIDTH; x++)
+        static const char layer_types[NUM_COST_LAYERS] = {PC, HIKER, RIVAL, PACER};
+        for (int layer = 0; layer < NUM_COST_LAYERS; layer++)
+        {
+            for (int y = 0; y < HEIGHT; y++)
+            {
+                for (int x = 0; x < WIDTH; x++)
+                {
+                    terrain->cost[layer][y][x] = get_movement_cost(terrain, x, y, layer_types[layer]);
+                    assert(terrain->cost[layer][y][x] == SHRT_MAX || TerrainCosts::contains(terrain->cost[layer][y][x]));
+                }
+            }
+        }
+        terrain->costs_valid = true;
+
+        // Distances computed from the old costs are no longer valid
+        if (terrain->distances != NULL)
         {
-            dist[y][x] = SHRT_MAX;
-            pq_add(pq, &pq_size, x, y, dist[y][x]);
+            terrain->distances->srcX = -1;
         }
     }
+    return terrain->cost[cost_layer(trainer_type)];
+}
 
-    dist[srcY][srcX] = 0;
-    pq_update_priority(pq, pq_size, srcX, srcY, dist[srcY][srcX]);
+// Trainer types that path toward the PC, in DistanceMaps plane order. Adding a type here (and bumping
+// NUM_PATHING_TYPES) gives it a distance map computed in the same traversal as the others.
+const char pathing_types[NUM_PATHING_TYPES] = {HIKER, RIVAL};
+
+// Returns the DistanceMaps plane of a trainer type, or -1 if it does not path toward the PC.
+int pathing_layer(char trainer_type)
+{
+    for (int layer = 0; layer < NUM_PATHING_TYPES; layer++)
+    {
+        if (pathing_types[layer] == trainer_type)
+        {
+            return layer;
+        }
+    }
+    return -1;
+}
 
-    while (pq_size > 0)
+// Settles every queued (layer, cell) node in one global distance order, so the wavefronts of all
+// pathing types sweep the board together, lowering each neighbor that can be reached more cheaply.
+template <class Queue>
+void dijkstra_relax(short (*costs[NUM_PATHING_TYPES])[WIDTH], DistanceMaps *maps, Queue *pq)
+{
+    while (pq->size > 0)
     {
-        PriorityQueueNode u = pq_extract_min(pq, &pq_size);
+        PriorityQueueNode u = pq_extract_min(pq);
+        short (*layerCosts)[WIDTH] = costs[u.layer];
+        int (*dist)[WIDTH] = maps->dist[u.layer];
 
         for (int dy = -1; dy <= 1; dy++)
         {
@@ -850,11 +2597,11 @@ void dijkstra_with_priority_queue(map *worldMap, int srcX, int srcY, int dist[HE
 
                 if (vY >= 0 && vY < HEIGHT && vX >= 0 && vX < WIDTH)
                 {
-                    int cost = get_movement_cost(worldMap, vX, vY, trainer_type);
+                    int cost = layerCosts[vY][vX];
                     if (cost != SHRT_MAX && dist[u.y][u.x] + cost < dist[vY][vX])
                     {
                         dist[vY][vX] = dist[u.y][u.x] + cost;
-                        pq_update_priority(pq, pq_size, vX, vY, dist[vY][vX]);
+                        pq_update_priority(pq, vX, vY, u.layer, dist[vY][vX]);
                     }
                 }
             }
@@ -862,17 +2609,88 @@ void dijkstra_with_priority_queue(map *worldMap, int srcX, int srcY, int dist[HE
     }
 }
 
+// Implements Dijkstra's algorithm using the given priority queue type to find the shortest paths from
+// (srcX, srcY) for every pathing trainer type at once.
+//
+// When maps already hold distances from a cell adjacent to the source, each plane is repaired instead
+// of rebuilt: stepping from the new source onto the old one costs c, so old distance + c is an upper
+// bound for every cell. A cell only beats that bound if its whole shortest path does, so seeding the
+// new source alone and expanding only improved cells yields exact distances while leaving cells closer
+// to the old source untouched. Planes whose old source cannot be entered are recomputed in full.
+template <class Queue>
+void dijkstra_with_queue(map *terrain, int srcX, int srcY, DistanceMaps *maps)
+{
+    short (*costs[NUM_PATHING_TYPES])[WIDTH];
+    bool repairable = maps->srcX != -1 && abs(maps->srcX - srcX) <= 1 && abs(maps->srcY - srcY) <= 1;
+    Queue pq;
+
+    for (int layer = 0; layer < NUM_PATHING_TYPES; layer++)
+    {
+        costs[layer] = movement_costs(terrain, pathing_types[layer]);
+        int (*dist)[WIDTH] = maps->dist[layer];
+        int step = repairable ? costs[layer][maps->srcY][maps->srcX] : SHRT_MAX;
+
+        // Only reached cells are queued; unreached cells keep SHRT_MAX and are never expanded.
+        for (int y = 0; y < HEIGHT; y++)
+        {
+            for (int x = 0; x < WIDTH; x++)
+            {
+                if (step == SHRT_MAX || dist[y][x] == SHRT_MAX)
+                {
+                    dist[y][x] = SHRT_MAX;
+                }
+                else
+                {
+                    dist[y][x] = std::min(dist[y][x] + step, SHRT_MAX);
+                }
+            }
+        }
+
+        dist[srcY][srcX] = 0;
+        pq_add(&pq, srcX, srcY, layer, dist[srcY][srcX]);
+    }
+
+    dijkstra_relax(costs, maps, &pq);
+    maps->srcX = srcX;
+    maps->srcY = srcY;
+}
+
+// Implements Dijkstra's algorithm with the priority queue best suited to the board's cost set:
+// Dial's bucket queue when the costs are small integers, the binary heap otherwise.
+template <class Costs>
+void dijkstra_with_priority_queue(map *terrain, int srcX, int srcY, DistanceMaps *maps)
+{
+    dijkstra_with_queue<typename QueueFor<Costs>::type>(terrain, srcX, srcY, maps);
+}
+
+// Returns the distance maps to the PC at (srcX, srcY) on a terrain map. They are cached per map: reused
+// as-is while the PC stays put, repaired incrementally when it moved by one cell, rebuilt otherwise.
+DistanceMaps *distance_maps(map *terrain, int srcX, int srcY)
+{
+    movement_costs(terrain, PC); // Rebuilding stale costs also invalidates cached distances
+    if (terrain->distances == NULL)
+    {
+        terrain->distances = new DistanceMaps;
+    }
+
+    if (terrain->distances->srcX != srcX || terrain->distances->srcY != srcY)
+    {
+        dijkstra_with_priority_queue<TerrainCosts>(terrain, srcX, srcY, terrain->distances);
+    }
+    return terrain->distances;
+}
+
 // Function to generate circular areas of terrain types with random number of regions and random sizes
 void growRegion(char board[HEIGHT][WIDTH], char terrainType)
 {
-    int numRegions = rand() % (MAX_REGIONS - MIN_REGIONS + 1) + MIN_REGIONS; // Random number of regions (5 to 13)
+    int numRegions = next_random(RNG_WORLD) % (MAX_REGIONS - MIN_REGIONS + 1) + MIN_REGIONS; // Random number of regions (5 to 13)
 
     for (int region = 0; region < numRegions; ++region)
     {
-        int centerX = rand() % WIDTH;  // Random x-coordinate within the map
-        int centerY = rand() % HEIGHT; // Random y-coordinate within the map
+        int centerX = next_random(RNG_WORLD) % WIDTH;  // Random x-coordinate within the map
+        int centerY = next_random(RNG_WORLD) % HEIGHT; // Random y-coordinate within the map
 
-        int radius = rand() % (MAX_RADIUS - MIN_RADIUS + 1) + MIN_RADIUS; // Random radius for the circular region
+        int radius = next_random(RNG_WORLD) % (MAX_RADIUS - MIN_RADIUS + 1) + MIN_RADIUS; // Random radius for the circular region
 
         for (int i = centerY - radius; i <= centerY + radius; ++i)
         {
@@ -896,13 +2714,16 @@ void growRegion(char board[HEIGHT][WIDTH], char terrainType)
     }
 }
 
-// Function to generate the world map
-void generateMap(map *world[MAP_SIZE][MAP_SIZE], int x, int y, int preX, int preY, int numtrainers, int flying)
+// Function to generate the world map at (x, y) on first visit; returns the map
+map *generateMap(int x, int y, int preX, int preY, int numtrainers, int flying)
 {
+    map *cur = get_map(x, y);
+
     // Check if the map at coordinates (x, y) is not already generated
-    if (world[y][x] == NULL)
+    if (cur == NULL)
     {
-        worldMap[y][x] = new map; // Allocate memory for a new map when it is first generated.
+        cur = new_map(x, y, numtrainers); // Allocate memory for a new map when it is first generated.
+        seed_map_random(x, y);
         int i, j;
 
         /*
@@ -919,34 +2740,34 @@ void generateMap(map *world[MAP_SIZE][MAP_SIZE], int x, int y, int preX, int pre
                 // Generate borders and terrain types randomly
                 if (i == 0 || i == HEIGHT - 1 || j == 0 || j == WIDTH - 1)
                 {
-                    world[y][x]->board[i][j] = BORDER; // Border
+                    cur->board[i][j] = BORDER; // Border
                 }
                 else
                 {
-                    int random = rand() % 100;
+                    int random = next_random(RNG_WORLD) % 100;
 
                     if (random < 98)
                     {
                         // Initialize 98% of the cells as grass
-                        world[y][x]->board[i][j] = GRASS;
+                        cur->board[i][j] = GRASS;
                     }
                     else
                     {
                         // Place individual trees
-                        world[y][x]->board[i][j] = TREE;
+                        cur->board[i][j] = TREE;
                     }
                 }
             }
         }
 
         // Region growing for water
-        growRegion(world[y][x]->board, WATER); // Generate circular regions of water
+        growRegion(cur->board, WATER); // Generate circular regions of water
 
         // Region growing for tall grass
-        growRegion(world[y][x]->board, TALL_GRASS); // Generate circular regions of tall grass
+        growRegion(cur->board, TALL_GRASS); // Generate circular regions of tall grass
 
         // Region growing for forests
-        growRegion(world[y][x]->board, TREE); // Generate circular regions of forests
+        growRegion(cur->board, TREE); // Generate circular regions of forests
 
         // Generate additional borders to ensure nothing goes out of line
         for (i = 0; i < HEIGHT; ++i)
@@ -955,7 +2776,7 @@ void generateMap(map *world[MAP_SIZE][MAP_SIZE], int x, int y, int preX, int pre
             {
                 if (i == 0 || i == HEIGHT - 1 || j == 0 || j == WIDTH - 1)
                 {
-                    world[y][x]->board[i][j] = BORDER; // Border
+                    cur->board[i][j] = BORDER; // Border
                 }
             }
         }
@@ -964,51 +2785,51 @@ void generateMap(map *world[MAP_SIZE][MAP_SIZE], int x, int y, int preX, int pre
         int North, South, East, West;
 
         // For the North road:
-        if (y > 0 && world[y - 1][x] != NULL)
+        if (y > 0 && get_map(x, y - 1) != NULL)
         {
             // If the map to the north exists, use its southern road position
-            North = world[y - 1][x]->South;
+            North = get_map(x, y - 1)->South;
         }
         else
         {
             // If there is no map to the north or we're at the edge, generate a random position
-            North = rand() % (WIDTH - 4) + 2;
+            North = next_random(RNG_WORLD) % (WIDTH - 4) + 2;
         }
 
         // For the South road:
-        if (y < MAP_SIZE - 1 && world[y + 1][x] != NULL)
+        if (y < MAP_SIZE - 1 && get_map(x, y + 1) != NULL)
         {
             // If the map to the south exists, use its northern road position
-            South = world[y + 1][x]->North;
+            South = get_map(x, y + 1)->North;
         }
         else
         {
             // If there is no map to the south or we're at the edge, generate a random position
-            South = rand() % (WIDTH - 4) + 2;
+            South = next_random(RNG_WORLD) % (WIDTH - 4) + 2;
         }
 
         // For the East road:
-        if (x < MAP_SIZE - 1 && world[y][x + 1] != NULL)
+        if (x < MAP_SIZE - 1 && get_map(x + 1, y) != NULL)
         {
             // If the map to the east exists, use its western road position
-            East = world[y][x + 1]->West;
+            East = get_map(x + 1, y)->West;
         }
         else
         {
             // If there is no map to the east or we're at the edge, generate a random position
-            East = rand() % (HEIGHT - 4) + 2;
+            East = next_random(RNG_WORLD) % (HEIGHT - 4) + 2;
         }
 
         // For the West road:
-        if (x > 0 && world[y][x - 1] != NULL)
+        if (x > 0 && get_map(x - 1, y) != NULL)
         {
             // If the map to the west exists, use its eastern road position
-            West = world[y][x - 1]->East;
+            West = get_map(x - 1, y)->East;
         }
         else
         {
             // If there is no map to the west or we're at the edge, generate a random position
-            West = rand() % (HEIGHT - 4) + 2;
+            West = next_random(RNG_WORLD) % (HEIGHT - 4) + 2;
         }
 
         // Minimum gap between gates
@@ -1069,30 +2890,30 @@ void generateMap(map *world[MAP_SIZE][MAP_SIZE], int x, int y, int preX, int pre
         }
 
         // Update the current map's path positions
-        world[y][x]->North = North;
-        world[y][x]->South = South;
-        world[y][x]->East = East;
-        world[y][x]->West = West;
+        cur->North = North;
+        cur->South = South;
+        cur->East = East;
+        cur->West = West;
 
         // Adding Roads at their correct positions
         // Generate a random vertical breaking point between 1/4 and 3/4 of the map height
-        int VerticalBreakingPoint = rand() % ((HEIGHT - 1) / 2) + ((HEIGHT - 1) / 4);
+        int VerticalBreakingPoint = next_random(RNG_WORLD) % ((HEIGHT - 1) / 2) + ((HEIGHT - 1) / 4);
 
         // Ensure the vertical breaking point doesn't overlap with the E-W path
         while (VerticalBreakingPoint == West || VerticalBreakingPoint == East)
         {
-            VerticalBreakingPoint = rand() % ((HEIGHT - 1) / 2) + ((HEIGHT - 1) / 4);
+            VerticalBreakingPoint = next_random(RNG_WORLD) % ((HEIGHT - 1) / 2) + ((HEIGHT - 1) / 4);
         }
 
         // Add path segments above the breaking point
         for (i = 0; i < VerticalBreakingPoint; i++)
         {
-            world[y][x]->board[i][North] = PATH;
+            cur->board[i][North] = PATH;
         }
         // Add path segments below the breaking point
         for (i = HEIGHT - 1; i > VerticalBreakingPoint; i--)
         {
-            world[y][x]->board[i][South] = PATH;
+            cur->board[i][South] = PATH;
         }
 
         // Fill in the path vertically from the southern gate to the northern gate, ensuring continuity.
@@ -1100,36 +2921,36 @@ void generateMap(map *world[MAP_SIZE][MAP_SIZE], int x, int y, int preX, int pre
         {
             for (i = South; i <= North; i++)
             {
-                world[y][x]->board[VerticalBreakingPoint][i] = PATH;
+                cur->board[VerticalBreakingPoint][i] = PATH;
             }
         }
         else
         {
             for (i = North; i <= South; i++)
             {
-                world[y][x]->board[VerticalBreakingPoint][i] = PATH;
+                cur->board[VerticalBreakingPoint][i] = PATH;
             }
         }
 
         // Generate a random horizontal breaking point between 1/4 and 3/4 of the map width
-        int HorizontalBreakingPoint = rand() % (WIDTH / 2) + (WIDTH / 4);
+        int HorizontalBreakingPoint = next_random(RNG_WORLD) % (WIDTH / 2) + (WIDTH / 4);
 
         // Ensure the horizontal breaking point does not overlap with the N-S path
         while (HorizontalBreakingPoint == North || HorizontalBreakingPoint == South)
         {
-            HorizontalBreakingPoint = rand() % (WIDTH / 2) + (WIDTH / 4);
+            HorizontalBreakingPoint = next_random(RNG_WORLD) % (WIDTH / 2) + (WIDTH / 4);
         }
 
         // Add path segments to the left of the breaking point
         for (i = 0; i < HorizontalBreakingPoint; i++)
         {
-            world[y][x]->board[West][i] = PATH;
+            cur->board[West][i] = PATH;
         }
 
         // Add path segments to the right of the breaking point
         for (i = WIDTH - 1; i > HorizontalBreakingPoint; i--)
         {
-            world[y][x]->board[East][i] = PATH;
+            cur->board[East][i] = PATH;
         }
 
         // Fill in the path horizontally from the western gate to the eastern gate, ensuring continuity.
@@ -1137,43 +2958,43 @@ void generateMap(map *world[MAP_SIZE][MAP_SIZE], int x, int y, int preX, int pre
         {
             for (i = East; i <= West; i++)
             {
-                world[y][x]->board[i][HorizontalBreakingPoint] = PATH;
+                cur->board[i][HorizontalBreakingPoint] = PATH;
             }
         }
         else
         {
             for (i = West; i <= East; i++)
             {
-                world[y][x]->board[i][HorizontalBreakingPoint] = PATH;
+                cur->board[i][HorizontalBreakingPoint] = PATH;
             }
         }
 
-        world[y][x]->VB = VerticalBreakingPoint;
-        world[y][x]->HB = HorizontalBreakingPoint;
+        cur->VB = VerticalBreakingPoint;
+        cur->HB = HorizontalBreakingPoint;
 
         // Place borders at the edges of the map to indicate its boundaries.
         // Borders at (-200, y)
         if (x == 0)
         {
-            world[y][x]->board[West][0] = BORDER;
+            cur->board[West][0] = BORDER;
         }
 
         // Borders at (200, y)
         if (x == MAP_SIZE - 1)
         {
-            world[y][x]->board[East][WIDTH - 1] = BORDER;
+            cur->board[East][WIDTH - 1] = BORDER;
         }
         
         // Borders at (x, -200)
         if (y == 0)
         {
-            world[y][x]->board[0][North] = BORDER;
+            cur->board[0][North] = BORDER;
         }
 
         // Borders at (x, 200)
         if (y == MAP_SIZE - 1)
         {
-            world[y][x]->board[HEIGHT - 1][South] = BORDER;
+            cur->board[HEIGHT - 1][South] = BORDER;
         }
 
         // Add PokeMart and PokeCenter with a probability based on the distance from the center
@@ -1185,12 +3006,12 @@ void generateMap(map *world[MAP_SIZE][MAP_SIZE], int x, int y, int preX, int pre
         int randTop, randLeft, randBottom, randRight;
         int l = 1, m = 1;
 
-        int buildingOffset = rand() % 8;
-        int random = rand() % 4;
-        randTop = rand() % (VerticalBreakingPoint - 1) + 1;
-        randLeft = rand() % (HorizontalBreakingPoint - 1) + 1;
-        randBottom = rand() % (HEIGHT - 1 - VerticalBreakingPoint) - 1;
-        randRight = rand() % (WIDTH - 1 - HorizontalBreakingPoint) - 1;
+        int buildingOffset = next_random(RNG_WORLD) % 8;
+        int random = next_random(RNG_WORLD) % 4;
+        randTop = next_random(RNG_WORLD) % (VerticalBreakingPoint - 1) + 1;
+        randLeft = next_random(RNG_WORLD) % (HorizontalBreakingPoint - 1) + 1;
+        randBottom = next_random(RNG_WORLD) % (HEIGHT - 1 - VerticalBreakingPoint) - 1;
+        randRight = next_random(RNG_WORLD) % (WIDTH - 1 - HorizontalBreakingPoint) - 1;
 
         int firstArray[4] = {1, 1, -1, -1};
         int secondArray[4] = {1, -1, 1, -1};
@@ -1200,307 +3021,297 @@ void generateMap(map *world[MAP_SIZE][MAP_SIZE], int x, int y, int preX, int pre
         {
             if (buildingOffset == 0)
             {
-                while (world[y][x]->board[randTop + l][North + firstArray[random]] == PATH)
+                while (cur->board[randTop + l][North + firstArray[random]] == PATH)
                 {
                     l--;
                 }
-                world[y][x]->board[randTop + l][North + firstArray[random]] = POKEMART;
+                cur->board[randTop + l][North + firstArray[random]] = POKEMART;
 
-                while (world[y][x]->board[West + secondArray[random]][randLeft + m] == PATH)
+                while (cur->board[West + secondArray[random]][randLeft + m] == PATH)
                 {
                     m--;
                 }
-                world[y][x]->board[West + secondArray[random]][randLeft + m] = POKEMON_CENTER;
+                cur->board[West + secondArray[random]][randLeft + m] = POKEMON_CENTER;
             }
             else if (buildingOffset == 1)
             {
-                while (world[y][x]->board[randTop + l][North + firstArray[random]] == PATH)
+                while (cur->board[randTop + l][North + firstArray[random]] == PATH)
                 {
                     l--;
                 }
-                world[y][x]->board[randTop + l][North + firstArray[random]] = POKEMART;
+                cur->board[randTop + l][North + firstArray[random]] = POKEMART;
 
-                while (world[y][x]->board[East + secondArray[random]][HorizontalBreakingPoint + randRight + m] == PATH)
+                while (cur->board[East + secondArray[random]][HorizontalBreakingPoint + randRight + m] == PATH)
                 {
                     m++;
                 }
-                world[y][x]->board[East + secondArray[random]][HorizontalBreakingPoint + randRight + m] = POKEMON_CENTER;
+                cur->board[East + secondArray[random]][HorizontalBreakingPoint + randRight + m] = POKEMON_CENTER;
             }
             else if (buildingOffset == 2)
             {
-                while (world[y][x]->board[VerticalBreakingPoint + randBottom + l][South + firstArray[random]] == PATH)
+                while (cur->board[VerticalBreakingPoint + randBottom + l][South + firstArray[random]] == PATH)
                 {
                     l++;
                 }
-                world[y][x]->board[VerticalBreakingPoint + randBottom + l][South + firstArray[random]] = POKEMART;
+                cur->board[VerticalBreakingPoint + randBottom + l][South + firstArray[random]] = POKEMART;
 
-                while (world[y][x]->board[West + secondArray[random]][randLeft + m] == PATH)
+                while (cur->board[West + secondArray[random]][randLeft + m] == PATH)
                 {
                     m--;
                 }
-                world[y][x]->board[West + secondArray[random]][randLeft + m] = POKEMON_CENTER;
+                cur->board[West + secondArray[random]][randLeft + m] = POKEMON_CENTER;
             }
             else if (buildingOffset == 3)
             {
-                while (world[y][x]->board[VerticalBreakingPoint + randBottom + l][South + firstArray[random]] == PATH)
+                while (cur->board[VerticalBreakingPoint + randBottom + l][South + firstArray[random]] == PATH)
                 {
                     l++;
                 }
-                world[y][x]->board[VerticalBreakingPoint + randBottom + l][South + firstArray[random]] = POKEMART;
+                cur->board[VerticalBreakingPoint + randBottom + l][South + firstArray[random]] = POKEMART;
 
-                while (world[y][x]->board[East + secondArray[random]][HorizontalBreakingPoint + randRight + m] == PATH)
+                while (cur->board[East + secondArray[random]][HorizontalBreakingPoint + randRight + m] == PATH)
                 {
                     m++;
                 }
-                world[y][x]->board[East + secondArray[random]][HorizontalBreakingPoint + randRight + m] = POKEMON_CENTER;
+                cur->board[East + secondArray[random]][HorizontalBreakingPoint + randRight + m] = POKEMON_CENTER;
             }
             else if (buildingOffset == 4)
             {
-                while (world[y][x]->board[randTop + l][North + firstArray[random]] == PATH)
+                while (cur->board[randTop + l][North + firstArray[random]] == PATH)
                 {
                     l--;
                 }
-                world[y][x]->board[randTop + l][North + firstArray[random]] = POKEMON_CENTER;
+                cur->board[randTop + l][North + firstArray[random]] = POKEMON_CENTER;
 
-                while (world[y][x]->board[West + secondArray[random]][randLeft + m] == PATH)
+                while (cur->board[West + secondArray[random]][randLeft + m] == PATH)
                 {
                     m--;
                 }
-                world[y][x]->board[West + secondArray[random]][randLeft + m] = POKEMART;
+                cur->board[West + secondArray[random]][randLeft + m] = POKEMART;
             }
             else if (buildingOffset == 5)
             {
-                while (world[y][x]->board[randTop + l][North + firstArray[random]] == PATH)
+                while (cur->board[randTop + l][North + firstArray[random]] == PATH)
                 {
                     l--;
                 }
-                world[y][x]->board[randTop + l][North + firstArray[random]] = POKEMON_CENTER;
+                cur->board[randTop + l][North + firstArray[random]] = POKEMON_CENTER;
 
-                while (world[y][x]->board[East + secondArray[random]][HorizontalBreakingPoint + randRight + m] == PATH)
+                while (cur->board[East + secondArray[random]][HorizontalBreakingPoint + randRight + m] == PATH)
                 {
                     m++;
                 }
-                world[y][x]->board[East + secondArray[random]][HorizontalBreakingPoint + randRight + m] = POKEMART;
+                cur->board[East + secondArray[random]][HorizontalBreakingPoint + randRight + m] = POKEMART;
             }
             else if (buildingOffset == 6)
             {
-                while (world[y][x]->board[VerticalBreakingPoint + randBottom + l][South + firstArray[random]] == PATH)
+                while (cur->board[VerticalBreakingPoint + randBottom + l][South + firstArray[random]] == PATH)
                 {
                     l++;
                 }
-                world[y][x]->board[VerticalBreakingPoint + randBottom + l][South + firstArray[random]] = POKEMON_CENTER;
+                cur->board[VerticalBreakingPoint + randBottom + l][South + firstArray[random]] = POKEMON_CENTER;
 
-                while (world[y][x]->board[West + secondArray[random]][randLeft + m] == PATH)
+                while (cur->board[West + secondArray[random]][randLeft + m] == PATH)
                 {
                     m--;
                 }
-                world[y][x]->board[West + secondArray[random]][randLeft + m] = POKEMART;
+                cur->board[West + secondArray[random]][randLeft + m] = POKEMART;
             }
             else if (buildingOffset == 7)
             {
-                while (world[y][x]->board[VerticalBreakingPoint + randBottom + l][South + firstArray[random]] == PATH)
+                while (cur->board[VerticalBreakingPoint + randBottom + l][South + firstArray[random]] == PATH)
                 {
                     l++;
                 }
-                world[y][x]->board[VerticalBreakingPoint + randBottom + l][South + firstArray[random]] = POKEMON_CENTER;
+                cur->board[VerticalBreakingPoint + randBottom + l][South + firstArray[random]] = POKEMON_CENTER;
 
-                while (world[y][x]->board[East + secondArray[random]][HorizontalBreakingPoint + randRight + m] == PATH)
+                while (cur->board[East + secondArray[random]][HorizontalBreakingPoint + randRight + m] == PATH)
                 {
                     m++;
                 }
-                world[y][x]->board[East + secondArray[random]][HorizontalBreakingPoint + randRight + m] = POKEMART;
+                cur->board[East + secondArray[random]][HorizontalBreakingPoint + randRight + m] = POKEMART;
             }
         }
         else
         {
-            if (rand() % 101 < chance)
+            if (next_random(RNG_WORLD) % 101 < chance)
             {
                 if (buildingOffset == 0)
                 {
-                    while (world[y][x]->board[randTop + l][North + firstArray[random]] == PATH)
+                    while (cur->board[randTop + l][North + firstArray[random]] == PATH)
                     {
                         l--;
                     }
-                    world[y][x]->board[randTop + l][North + firstArray[random]] = POKEMART;
+                    cur->board[randTop + l][North + firstArray[random]] = POKEMART;
                 }
                 else if (buildingOffset == 1)
                 {
-                    while (world[y][x]->board[randTop + l][North + firstArray[random]] == PATH)
+                    while (cur->board[randTop + l][North + firstArray[random]] == PATH)
                     {
                         l--;
                     }
-                    world[y][x]->board[randTop + l][North + firstArray[random]] = POKEMART;
+                    cur->board[randTop + l][North + firstArray[random]] = POKEMART;
                 }
                 else if (buildingOffset == 2)
                 {
-                    while (world[y][x]->board[VerticalBreakingPoint + randBottom + l][South + firstArray[random]] == PATH)
+                    while (cur->board[VerticalBreakingPoint + randBottom + l][South + firstArray[random]] == PATH)
                     {
                         l++;
                     }
-                    world[y][x]->board[VerticalBreakingPoint + randBottom + l][South + firstArray[random]] = POKEMART;
+                    cur->board[VerticalBreakingPoint + randBottom + l][South + firstArray[random]] = POKEMART;
                 }
                 else if (buildingOffset == 3)
                 {
-                    while (world[y][x]->board[VerticalBreakingPoint + randBottom + l][South + firstArray[random]] == PATH)
+                    while (cur->board[VerticalBreakingPoint + randBottom + l][South + firstArray[random]] == PATH)
                     {
                         l++;
                     }
-                    world[y][x]->board[VerticalBreakingPoint + randBottom + l][South + firstArray[random]] = POKEMART;
+                    cur->board[VerticalBreakingPoint + randBottom + l][South + firstArray[random]] = POKEMART;
                 }
                 else if (buildingOffset == 4)
                 {
-                    while (world[y][x]->board[West + secondArray[random]][randLeft + m] == PATH)
+                    while (cur->board[West + secondArray[random]][randLeft + m] == PATH)
                     {
                         m--;
                     }
-                    world[y][x]->board[West + secondArray[random]][randLeft + m] = POKEMART;
+                    cur->board[West + secondArray[random]][randLeft + m] = POKEMART;
                 }
                 else if (buildingOffset == 5)
                 {
-                    while (world[y][x]->board[East + secondArray[random]][HorizontalBreakingPoint + randRight + m] == PATH)
+                    while (cur->board[East + secondArray[random]][HorizontalBreakingPoint + randRight + m] == PATH)
                     {
                         m++;
                     }
-                    world[y][x]->board[East + secondArray[random]][HorizontalBreakingPoint + randRight + m] = POKEMART;
+                    cur->board[East + secondArray[random]][HorizontalBreakingPoint + randRight + m] = POKEMART;
                 }
                 else if (buildingOffset == 6)
                 {
-                    while (world[y][x]->board[West + secondArray[random]][randLeft + m] == PATH)
+                    while (cur->board[West + secondArray[random]][randLeft + m] == PATH)
                     {
                         m--;
                     }
-                    world[y][x]->board[West + secondArray[random]][randLeft + m] = POKEMART;
+                    cur->board[West + secondArray[random]][randLeft + m] = POKEMART;
                 }
                 else if (buildingOffset == 7)
                 {
-                    while (world[y][x]->board[East + secondArray[random]][HorizontalBreakingPoint + randRight + m] == PATH)
+                    while (cur->board[East + secondArray[random]][HorizontalBreakingPoint + randRight + m] == PATH)
                     {
                         m++;
                     }
-                    world[y][x]->board[East + secondArray[random]][HorizontalBreakingPoint + randRight + m] = POKEMART;
+                    cur->board[East + secondArray[random]][HorizontalBreakingPoint + randRight + m] = POKEMART;
                 }
             }
 
             l = 1, m = 1;
 
-            if (rand() % 101 < chance)
+            if (next_random(RNG_WORLD) % 101 < chance)
             {
                 if (buildingOffset == 0)
                 {
-                    while (world[y][x]->board[West + secondArray[random]][randLeft + m] == PATH)
+                    while (cur->board[West + secondArray[random]][randLeft + m] == PATH)
                     {
                         m--;
                     }
-                    world[y][x]->board[West + secondArray[random]][randLeft + m] = POKEMON_CENTER;
+                    cur->board[West + secondArray[random]][randLeft + m] = POKEMON_CENTER;
                 }
                 else if (buildingOffset == 1)
                 {
-                    while (world[y][x]->board[East + secondArray[random]][HorizontalBreakingPoint + randRight + m] == PATH)
+                    while (cur->board[East + secondArray[random]][HorizontalBreakingPoint + randRight + m] == PATH)
                     {
                         m++;
                     }
-                    world[y][x]->board[East + secondArray[random]][HorizontalBreakingPoint + randRight + m] = POKEMON_CENTER;
+                    cur->board[East + secondArray[random]][HorizontalBreakingPoint + randRight + m] = POKEMON_CENTER;
                 }
                 else if (buildingOffset == 2)
                 {
-                    while (world[y][x]->board[West + secondArray[random]][randLeft + m] == PATH)
+                    while (cur->board[West + secondArray[random]][randLeft + m] == PATH)
                     {
                         m--;
                     }
-                    world[y][x]->board[West + secondArray[random]][randLeft + m] = POKEMON_CENTER;
+                    cur->board[West + secondArray[random]][randLeft + m] = POKEMON_CENTER;
                 }
                 else if (buildingOffset == 3)
                 {
-                    while (world[y][x]->board[East + secondArray[random]][HorizontalBreakingPoint + randRight + m] == PATH)
+                    while (cur->board[East + secondArray[random]][HorizontalBreakingPoint + randRight + m] == PATH)
                     {
                         m++;
                     }
-                    world[y][x]->board[East + secondArray[random]][HorizontalBreakingPoint + randRight + m] = POKEMON_CENTER;
+                    cur->board[East + secondArray[random]][HorizontalBreakingPoint + randRight + m] = POKEMON_CENTER;
                 }
                 else if (buildingOffset == 4)
                 {
-                    while (world[y][x]->board[randTop + l][North + firstArray[random]] == PATH)
+                    while (cur->board[randTop + l][North + firstArray[random]] == PATH)
                     {
                         l--;
                     }
-                    world[y][x]->board[randTop + l][North + firstArray[random]] = POKEMON_CENTER;
+                    cur->board[randTop + l][North + firstArray[random]] = POKEMON_CENTER;
                 }
                 else if (buildingOffset == 5)
                 {
-                    while (world[y][x]->board[randTop + l][North + firstArray[random]] == PATH)
+                    while (cur->board[randTop + l][North + firstArray[random]] == PATH)
                     {
                         l--;
                     }
-                    world[y][x]->board[randTop + l][North + firstArray[random]] = POKEMON_CENTER;
+                    cur->board[randTop + l][North + firstArray[random]] = POKEMON_CENTER;
                 }
                 else if (buildingOffset == 6)
                 {
-                    while (world[y][x]->board[VerticalBreakingPoint + randBottom + l][South + firstArray[random]] == PATH)
+                    while (cur->board[VerticalBreakingPoint + randBottom + l][South + firstArray[random]] == PATH)
                     {
                         l++;
                     }
-                    world[y][x]->board[VerticalBreakingPoint + randBottom + l][South + firstArray[random]] = POKEMON_CENTER;
+                    cur->board[VerticalBreakingPoint + randBottom + l][South + firstArray[random]] = POKEMON_CENTER;
                 }
                 else if (buildingOffset == 7)
                 {
-                    while (world[y][x]->board[VerticalBreakingPoint + randBottom + l][South + firstArray[random]] == PATH)
+                    while (cur->board[VerticalBreakingPoint + randBottom + l][South + firstArray[random]] == PATH)
                     {
                         l++;
                     }
-                    world[y][x]->board[VerticalBreakingPoint + randBottom + l][South + firstArray[random]] = POKEMON_CENTER;
+                    cur->board[VerticalBreakingPoint + randBottom + l][South + firstArray[random]] = POKEMON_CENTER;
                 }
             }
         }
 
-        // Allocate a new map structure for the first layer
-        firstLayer[y][x] = new map;
-
-        // Copy the contents of the current map to the first layer
-        for (int i = 0; i < HEIGHT; ++i) {
-            for (int j = 0; j < WIDTH; ++j) {
-                firstLayer[y][x]->board[i][j] = worldMap[y][x]->board[i][j];
-            }
-        }
-
-        buildingOffset = rand() % 4;
-        randTop = rand() % (VerticalBreakingPoint - 1) + 1;
-        randLeft = rand() % (HorizontalBreakingPoint - 1) + 1;
-        randBottom = rand() % (HEIGHT - 1 - VerticalBreakingPoint) - 1;
-        randRight = rand() % (WIDTH - 1 - HorizontalBreakingPoint) - 1;
+        buildingOffset = next_random(RNG_WORLD) % 4;
+        randTop = next_random(RNG_WORLD) % (VerticalBreakingPoint - 1) + 1;
+        randLeft = next_random(RNG_WORLD) % (HorizontalBreakingPoint - 1) + 1;
+        randBottom = next_random(RNG_WORLD) % (HEIGHT - 1 - VerticalBreakingPoint) - 1;
+        randRight = next_random(RNG_WORLD) % (WIDTH - 1 - HorizontalBreakingPoint) - 1;
         l = 1, m = 1;
 
         if ((x == MAP_CENTER && y == MAP_CENTER) || (flying == 1)){
             if (buildingOffset == 0)
             {
-                while (world[y][x]->board[West][randLeft + m] != PATH)
+                while (cur->board[West][randLeft + m] != PATH)
                 {
                     m--;
                 }
-                world[y][x]->board[West][randLeft + m] = PC;
+                place_pc(cur, randLeft + m, West);
             }
             else if (buildingOffset == 1)
             {
-                while (world[y][x]->board[East][HorizontalBreakingPoint + randRight + m] != PATH)
+                while (cur->board[East][HorizontalBreakingPoint + randRight + m] != PATH)
                 {
                     m++;
                 }
-                world[y][x]->board[East][HorizontalBreakingPoint + randRight + m] = PC;
+                place_pc(cur, HorizontalBreakingPoint + randRight + m, East);
             }
             else if (buildingOffset == 2)
             {
-                while (world[y][x]->board[randTop + l][North] != PATH)
+                while (cur->board[randTop + l][North] != PATH)
                 {
                     l--;
                 }
-                world[y][x]->board[randTop + l][North] = PC;
+                place_pc(cur, North, randTop + l);
             }
             else if (buildingOffset == 3)
             {
-                while (world[y][x]->board[VerticalBreakingPoint + randBottom + l][South] != PATH)
+                while (cur->board[VerticalBreakingPoint + randBottom + l][South] != PATH)
                 {
                     l++;
                 }
-                world[y][x]->board[VerticalBreakingPoint + randBottom + l][South] = PC;
+                place_pc(cur, South, VerticalBreakingPoint + randBottom + l);
             }
         }
 
@@ -1508,248 +3319,257 @@ void generateMap(map *world[MAP_SIZE][MAP_SIZE], int x, int y, int preX, int pre
         
         // Ensure there is at least one hiker and one rival on the map unless numtrainers is less than 2
         if (numtrainers == 2) {
-            random_x = rand() % (WIDTH - 2) + 1;
-            random_y = rand() % (HEIGHT - 2) + 1;
+            random_x = next_random(RNG_WORLD) % (WIDTH - 2) + 1;
+            random_y = next_random(RNG_WORLD) % (HEIGHT - 2) + 1;
 
-            while (world[y][x]->board[random_y][random_x] != GRASS && world[y][x]->board[random_y][random_x] != TALL_GRASS && world[y][x]->board[random_y][random_x] != PATH && !(world[y][x]->board[random_y][random_x] == TREE && is_forest(world[y][x], random_x, random_y)))
+            while (is_occupied(cur, random_x, random_y) || (cur->board[random_y][random_x] != GRASS && cur->board[random_y][random_x] != TALL_GRASS && cur->board[random_y][random_x] != PATH && !(cur->board[random_y][random_x] == TREE && is_forest(cur->board, random_x, random_y))))
             {
-                random_x = rand() % (WIDTH - 2) + 1;
-                random_y = rand() % (HEIGHT - 2) + 1;
+                random_x = next_random(RNG_WORLD) % (WIDTH - 2) + 1;
+                random_y = next_random(RNG_WORLD) % (HEIGHT - 2) + 1;
             }
 
-            if (world[y][x]->board[random_y][random_x] == GRASS || world[y][x]->board[random_y][random_x] == TALL_GRASS || world[y][x]->board[random_y][random_x] == PATH || (world[y][x]->board[random_y][random_x] == TREE && is_forest(world[y][x], random_x, random_y)))
+            if (!is_occupied(cur, random_x, random_y) && (cur->board[random_y][random_x] == GRASS || cur->board[random_y][random_x] == TALL_GRASS || cur->board[random_y][random_x] == PATH || (cur->board[random_y][random_x] == TREE && is_forest(cur->board, random_x, random_y))))
             {
-                world[y][x]->board[random_y][random_x] = HIKER;
+                add_trainer(cur, random_x, random_y, HIKER, x, y);
             }
 
-            random_x = rand() % (WIDTH - 2) + 1;
-            random_y = rand() % (HEIGHT - 2) + 1;
+            random_x = next_random(RNG_WORLD) % (WIDTH - 2) + 1;
+            random_y = next_random(RNG_WORLD) % (HEIGHT - 2) + 1;
 
-            while (world[y][x]->board[random_y][random_x] != GRASS && world[y][x]->board[random_y][random_x] != TALL_GRASS && world[y][x]->board[random_y][random_x] != PATH)
+            while (is_occupied(cur, random_x, random_y) || (cur->board[random_y][random_x] != GRASS && cur->board[random_y][random_x] != TALL_GRASS && cur->board[random_y][random_x] != PATH))
             {
-                random_x = rand() % (WIDTH - 2) + 1;
-                random_y = rand() % (HEIGHT - 2) + 1;
+                random_x = next_random(RNG_WORLD) % (WIDTH - 2) + 1;
+                random_y = next_random(RNG_WORLD) % (HEIGHT - 2) + 1;
             }
 
-            if (world[y][x]->board[random_y][random_x] == GRASS || world[y][x]->board[random_y][random_x] == TALL_GRASS || world[y][x]->board[random_y][random_x] == PATH)
+            if (!is_occupied(cur, random_x, random_y) && (cur->board[random_y][random_x] == GRASS || cur->board[random_y][random_x] == TALL_GRASS || cur->board[random_y][random_x] == PATH))
             {
-                world[y][x]->board[random_y][random_x] = RIVAL;
+                add_trainer(cur, random_x, random_y, RIVAL, x, y);
             }
         } else if (numtrainers > 2) {
-            random_x = rand() % (WIDTH - 2) + 1;
-            random_y = rand() % (HEIGHT - 2) + 1;
+            random_x = next_random(RNG_WORLD) % (WIDTH - 2) + 1;
+            random_y = next_random(RNG_WORLD) % (HEIGHT - 2) + 1;
             int maxAttempts = WIDTH * HEIGHT;
             int attempts = 0;
 
-            while (attempts < maxAttempts && world[y][x]->board[random_y][random_x] != GRASS && world[y][x]->board[random_y][random_x] != TALL_GRASS && world[y][x]->board[random_y][random_x] != PATH && !(world[y][x]->board[random_y][random_x] == TREE && is_forest(world[y][x], random_x, random_y)))
+            while (attempts < maxAttempts && (is_occupied(cur, random_x, random_y) || (cur->board[random_y][random_x] != GRASS && cur->board[random_y][random_x] != TALL_GRASS && cur->board[random_y][random_x] != PATH && !(cur->board[random_y][random_x] == TREE && is_forest(cur->board, random_x, random_y)))))
             {
-                random_x = rand() % (WIDTH - 2) + 1;
-                random_y = rand() % (HEIGHT - 2) + 1;
+                random_x = next_random(RNG_WORLD) % (WIDTH - 2) + 1;
+                random_y = next_random(RNG_WORLD) % (HEIGHT - 2) + 1;
                 attempts++;
             }
 
-            if (world[y][x]->board[random_y][random_x] == GRASS || world[y][x]->board[random_y][random_x] == TALL_GRASS || world[y][x]->board[random_y][random_x] == PATH || (world[y][x]->board[random_y][random_x] == TREE && is_forest(world[y][x], random_x, random_y)))
+            if (!is_occupied(cur, random_x, random_y) && (cur->board[random_y][random_x] == GRASS || cur->board[random_y][random_x] == TALL_GRASS || cur->board[random_y][random_x] == PATH || (cur->board[random_y][random_x] == TREE && is_forest(cur->board, random_x, random_y))))
             {
-                world[y][x]->board[random_y][random_x] = HIKER;
+                add_trainer(cur, random_x, random_y, HIKER, x, y);
             }
 
-            random_x = rand() % (WIDTH - 2) + 1;
-            random_y = rand() % (HEIGHT - 2) + 1;
+            random_x = next_random(RNG_WORLD) % (WIDTH - 2) + 1;
+            random_y = next_random(RNG_WORLD) % (HEIGHT - 2) + 1;
 
             attempts = 0;
-            while (attempts < maxAttempts && world[y][x]->board[random_y][random_x] != GRASS && world[y][x]->board[random_y][random_x] != TALL_GRASS && world[y][x]->board[random_y][random_x] != PATH)
+            while (attempts < maxAttempts && (is_occupied(cur, random_x, random_y) || (cur->board[random_y][random_x] != GRASS && cur->board[random_y][random_x] != TALL_GRASS && cur->board[random_y][random_x] != PATH)))
             {
-                random_x = rand() % (WIDTH - 2) + 1;
-                random_y = rand() % (HEIGHT - 2) + 1;
+                random_x = next_random(RNG_WORLD) % (WIDTH - 2) + 1;
+                random_y = next_random(RNG_WORLD) % (HEIGHT - 2) + 1;
                 attempts++;
             }
 
-            if (world[y][x]->board[random_y][random_x] == GRASS || world[y][x]->board[random_y][random_x] == TALL_GRASS || world[y][x]->board[random_y][random_x] == PATH)
+            if (!is_occupied(cur, random_x, random_y) && (cur->board[random_y][random_x] == GRASS || cur->board[random_y][random_x] == TALL_GRASS || cur->board[random_y][random_x] == PATH))
             {
-                world[y][x]->board[random_y][random_x] = RIVAL;
+                add_trainer(cur, random_x, random_y, RIVAL, x, y);
             }
 
             for (int c = 0; c < numtrainers - 2; c++){
-                random_case = rand() % 6;
+                random_case = next_random(RNG_WORLD) % 6;
 
                 if (random_case == 0){
-                    random_x = rand() % (WIDTH - 2) + 1;
-                    random_y = rand() % (HEIGHT - 2) + 1;
+                    random_x = next_random(RNG_WORLD) % (WIDTH - 2) + 1;
+                    random_y = next_random(RNG_WORLD) % (HEIGHT - 2) + 1;
 
                     attempts = 0;
-                    while (attempts < maxAttempts && world[y][x]->board[random_y][random_x] != GRASS && world[y][x]->board[random_y][random_x] != TALL_GRASS && world[y][x]->board[random_y][random_x] != PATH && !(world[y][x]->board[random_y][random_x] == TREE && is_forest(world[y][x], random_x, random_y)))
+                    while (attempts < maxAttempts && (is_occupied(cur, random_x, random_y) || (cur->board[random_y][random_x] != GRASS && cur->board[random_y][random_x] != TALL_GRASS && cur->board[random_y][random_x] != PATH && !(cur->board[random_y][random_x] == TREE && is_forest(cur->board, random_x, random_y)))))
                     {
-                        random_x = rand() % (WIDTH - 2) + 1;
-                        random_y = rand() % (HEIGHT - 2) + 1;
+                        random_x = next_random(RNG_WORLD) % (WIDTH - 2) + 1;
+                        random_y = next_random(RNG_WORLD) % (HEIGHT - 2) + 1;
                         attempts++;
                     }
 
-                    if (world[y][x]->board[random_y][random_x] == GRASS || world[y][x]->board[random_y][random_x] == TALL_GRASS || world[y][x]->board[random_y][random_x] == PATH || (world[y][x]->board[random_y][random_x] == TREE && is_forest(world[y][x], random_x, random_y)))
+                    if (!is_occupied(cur, random_x, random_y) && (cur->board[random_y][random_x] == GRASS || cur->board[random_y][random_x] == TALL_GRASS || cur->board[random_y][random_x] == PATH || (cur->board[random_y][random_x] == TREE && is_forest(cur->board, random_x, random_y))))
                     {
-                        world[y][x]->board[random_y][random_x] = HIKER;
+                        add_trainer(cur, random_x, random_y, HIKER, x, y);
                     }
                 } else if (random_case == 1){
-                    random_x = rand() % (WIDTH - 2) + 1;
-                    random_y = rand() % (HEIGHT - 2) + 1;
+                    random_x = next_random(RNG_WORLD) % (WIDTH - 2) + 1;
+                    random_y = next_random(RNG_WORLD) % (HEIGHT - 2) + 1;
 
                     attempts = 0;
-                    while (attempts < maxAttempts && world[y][x]->board[random_y][random_x] != GRASS && world[y][x]->board[random_y][random_x] != TALL_GRASS && world[y][x]->board[random_y][random_x] != PATH)
+                    while (attempts < maxAttempts && (is_occupied(cur, random_x, random_y) || (cur->board[random_y][random_x] != GRASS && cur->board[random_y][random_x] != TALL_GRASS && cur->board[random_y][random_x] != PATH)))
                     {
-                        random_x = rand() % (WIDTH - 2) + 1;
-                        random_y = rand() % (HEIGHT - 2) + 1;
+                        random_x = next_random(RNG_WORLD) % (WIDTH - 2) + 1;
+                        random_y = next_random(RNG_WORLD) % (HEIGHT - 2) + 1;
                         attempts++;
                     }
 
-                    if (world[y][x]->board[random_y][random_x] == GRASS || world[y][x]->board[random_y][random_x] == TALL_GRASS || world[y][x]->board[random_y][random_x] == PATH)
+                    if (!is_occupied(cur, random_x, random_y) && (cur->board[random_y][random_x] == GRASS || cur->board[random_y][random_x] == TALL_GRASS || cur->board[random_y][random_x] == PATH))
                     {
-                        world[y][x]->board[random_y][random_x] = RIVAL;
+                        add_trainer(cur, random_x, random_y, RIVAL, x, y);
                     }
                 } else if (random_case == 2){
-                    random_x = rand() % (WIDTH - 2) + 1;
-                    random_y = rand() % (HEIGHT - 2) + 1;
+                    random_x = next_random(RNG_WORLD) % (WIDTH - 2) + 1;
+                    random_y = next_random(RNG_WORLD) % (HEIGHT - 2) + 1;
 
                     attempts = 0;
-                    while (attempts < maxAttempts && world[y][x]->board[random_y][random_x] != GRASS && world[y][x]->board[random_y][random_x] != TALL_GRASS && world[y][x]->board[random_y][random_x] != PATH)
+                    while (attempts < maxAttempts && (is_occupied(cur, random_x, random_y) || (cur->board[random_y][random_x] != GRASS && cur->board[random_y][random_x] != TALL_GRASS && cur->board[random_y][random_x] != PATH)))
                     {
-                        random_x = rand() % (WIDTH - 2) + 1;
-                        random_y = rand() % (HEIGHT - 2) + 1;
+                        random_x = next_random(RNG_WORLD) % (WIDTH - 2) + 1;
+                        random_y = next_random(RNG_WORLD) % (HEIGHT - 2) + 1;
                         attempts++;
                     }
 
-                    if (world[y][x]->board[random_y][random_x] == GRASS || world[y][x]->board[random_y][random_x] == TALL_GRASS || world[y][x]->board[random_y][random_x] == PATH)
+                    if (!is_occupied(cur, random_x, random_y) && (cur->board[random_y][random_x] == GRASS || cur->board[random_y][random_x] == TALL_GRASS || cur->board[random_y][random_x] == PATH))
                     {
-                        world[y][x]->board[random_y][random_x] = PACER;
+                        add_trainer(cur, random_x, random_y, PACER, x, y);
                     }
                 } else if (random_case == 3){
-                    random_x = rand() % (WIDTH - 2) + 1;
-                    random_y = rand() % (HEIGHT - 2) + 1;
+                    random_x = next_random(RNG_WORLD) % (WIDTH - 2) + 1;
+                    random_y = next_random(RNG_WORLD) % (HEIGHT - 2) + 1;
 
                     attempts = 0;
-                    while (attempts < maxAttempts && world[y][x]->board[random_y][random_x] != GRASS && world[y][x]->board[random_y][random_x] != TALL_GRASS && world[y][x]->board[random_y][random_x] != PATH)
+                    while (attempts < maxAttempts && (is_occupied(cur, random_x, random_y) || (cur->board[random_y][random_x] != GRASS && cur->board[random_y][random_x] != TALL_GRASS && cur->board[random_y][random_x] != PATH)))
                     {
-                        random_x = rand() % (WIDTH - 2) + 1;
-                        random_y = rand() % (HEIGHT - 2) + 1;
+                        random_x = next_random(RNG_WORLD) % (WIDTH - 2) + 1;
+                        random_y = next_random(RNG_WORLD) % (HEIGHT - 2) + 1;
                         attempts++;
                     }
 
-                    if (world[y][x]->board[random_y][random_x] == GRASS || world[y][x]->board[random_y][random_x] == TALL_GRASS || world[y][x]->board[random_y][random_x] == PATH)
+                    if (!is_occupied(cur, random_x, random_y) && (cur->board[random_y][random_x] == GRASS || cur->board[random_y][random_x] == TALL_GRASS || cur->board[random_y][random_x] == PATH))
                     {
-                        world[y][x]->board[random_y][random_x] = WANDERER;
+                        add_trainer(cur, random_x, random_y, WANDERER, x, y);
                     }
                 } else if (random_case == 4){
-                    random_x = rand() % (WIDTH - 2) + 1;
-                    random_y = rand() % (HEIGHT - 2) + 1;
+                    random_x = next_random(RNG_WORLD) % (WIDTH - 2) + 1;
+                    random_y = next_random(RNG_WORLD) % (HEIGHT - 2) + 1;
 
                     attempts = 0;
-                    while (attempts < maxAttempts && world[y][x]->board[random_y][random_x] != GRASS && world[y][x]->board[random_y][random_x] != TALL_GRASS && world[y][x]->board[random_y][random_x] != PATH)
+                    while (attempts < maxAttempts && (is_occupied(cur, random_x, random_y) || (cur->board[random_y][random_x] != GRASS && cur->board[random_y][random_x] != TALL_GRASS && cur->board[random_y][random_x] != PATH)))
                     {
-                        random_x = rand() % (WIDTH - 2) + 1;
-                        random_y = rand() % (HEIGHT - 2) + 1;
+                        random_x = next_random(RNG_WORLD) % (WIDTH - 2) + 1;
+                        random_y = next_random(RNG_WORLD) % (HEIGHT - 2) + 1;
                         attempts++;
                     }
 
-                    if (world[y][x]->board[random_y][random_x] == GRASS || world[y][x]->board[random_y][random_x] == TALL_GRASS || world[y][x]->board[random_y][random_x] == PATH)
+                    if (!is_occupied(cur, random_x, random_y) && (cur->board[random_y][random_x] == GRASS || cur->board[random_y][random_x] == TALL_GRASS || cur->board[random_y][random_x] == PATH))
                     {
-                        world[y][x]->board[random_y][random_x] = SENTRY;
+                        add_trainer(cur, random_x, random_y, SENTRY, x, y);
                     }
                 } else {
-                    random_x = rand() % (WIDTH - 2) + 1;
-                    random_y = rand() % (HEIGHT - 2) + 1;
+                    random_x = next_random(RNG_WORLD) % (WIDTH - 2) + 1;
+                    random_y = next_random(RNG_WORLD) % (HEIGHT - 2) + 1;
 
                     attempts = 0;
-                    while (attempts < maxAttempts && world[y][x]->board[random_y][random_x] != GRASS && world[y][x]->board[random_y][random_x] != TALL_GRASS && world[y][x]->board[random_y][random_x] != PATH)
+                    while (attempts < maxAttempts && (is_occupied(cur, random_x, random_y) || (cur->board[random_y][random_x] != GRASS && cur->board[random_y][random_x] != TALL_GRASS && cur->board[random_y][random_x] != PATH)))
                     {
-                        random_x = rand() % (WIDTH - 2) + 1;
-                        random_y = rand() % (HEIGHT - 2) + 1;
+                        random_x = next_random(RNG_WORLD) % (WIDTH - 2) + 1;
+                        random_y = next_random(RNG_WORLD) % (HEIGHT - 2) + 1;
                         attempts++;
                     }
 
-                    if (world[y][x]->board[random_y][random_x] == GRASS || world[y][x]->board[random_y][random_x] == TALL_GRASS || world[y][x]->board[random_y][random_x] == PATH)
+                    if (!is_occupied(cur, random_x, random_y) && (cur->board[random_y][random_x] == GRASS || cur->board[random_y][random_x] == TALL_GRASS || cur->board[random_y][random_x] == PATH))
                     {
-                        world[y][x]->board[random_y][random_x] = EXPLORER;
+                        add_trainer(cur, random_x, random_y, EXPLORER, x, y);
                     }
                 }
             }
         } else if (numtrainers == 1) {
             // Place either a hiker or a rival on the map
             // Your code to place either a hiker or a rival...
-            random_case = rand() % 2;
+            random_case = next_random(RNG_WORLD) % 2;
             if (random_case == 1){
-                random_x = rand() % (WIDTH - 2) + 1;
-                random_y = rand() % (HEIGHT - 2) + 1;
+                random_x = next_random(RNG_WORLD) % (WIDTH - 2) + 1;
+                random_y = next_random(RNG_WORLD) % (HEIGHT - 2) + 1;
 
-                while (world[y][x]->board[random_y][random_x] != GRASS && world[y][x]->board[random_y][random_x] != TALL_GRASS && world[y][x]->board[random_y][random_x] != PATH && !(world[y][x]->board[random_y][random_x] == TREE && is_forest(world[y][x], random_x, random_y)))
+                while (is_occupied(cur, random_x, random_y) || (cur->board[random_y][random_x] != GRASS && cur->board[random_y][random_x] != TALL_GRASS && cur->board[random_y][random_x] != PATH && !(cur->board[random_y][random_x] == TREE && is_forest(cur->board, random_x, random_y))))
                 {
-                    random_x = rand() % (WIDTH - 2) + 1;
-                    random_y = rand() % (HEIGHT - 2) + 1;
+                    random_x = next_random(RNG_WORLD) % (WIDTH - 2) + 1;
+                    random_y = next_random(RNG_WORLD) % (HEIGHT - 2) + 1;
                 }
 
-                if (world[y][x]->board[random_y][random_x] == GRASS || world[y][x]->board[random_y][random_x] == TALL_GRASS || world[y][x]->board[random_y][random_x] == PATH || (world[y][x]->board[random_y][random_x] == TREE && is_forest(world[y][x], random_x, random_y)))
+                if (!is_occupied(cur, random_x, random_y) && (cur->board[random_y][random_x] == GRASS || cur->board[random_y][random_x] == TALL_GRASS || cur->board[random_y][random_x] == PATH || (cur->board[random_y][random_x] == TREE && is_forest(cur->board, random_x, random_y))))
                 {
-                    world[y][x]->board[random_y][random_x] = HIKER;
+                    add_trainer(cur, random_x, random_y, HIKER, x, y);
                 }
             } else {
-                random_x = rand() % (WIDTH - 2) + 1;
-                random_y = rand() % (HEIGHT - 2) + 1;
+                random_x = next_random(RNG_WORLD) % (WIDTH - 2) + 1;
+                random_y = next_random(RNG_WORLD) % (HEIGHT - 2) + 1;
 
-                while (world[y][x]->board[random_y][random_x] != GRASS && world[y][x]->board[random_y][random_x] != TALL_GRASS && world[y][x]->board[random_y][random_x] != PATH)
+                while (is_occupied(cur, random_x, random_y) || (cur->board[random_y][random_x] != GRASS && cur->board[random_y][random_x] != TALL_GRASS && cur->board[random_y][random_x] != PATH))
                 {
-                    random_x = rand() % (WIDTH - 2) + 1;
-                    random_y = rand() % (HEIGHT - 2) + 1;
+                    random_x = next_random(RNG_WORLD) % (WIDTH - 2) + 1;
+                    random_y = next_random(RNG_WORLD) % (HEIGHT - 2) + 1;
                 }
 
-                if (world[y][x]->board[random_y][random_x] == GRASS || world[y][x]->board[random_y][random_x] == TALL_GRASS || world[y][x]->board[random_y][random_x] == PATH)
+                if (!is_occupied(cur, random_x, random_y) && (cur->board[random_y][random_x] == GRASS || cur->board[random_y][random_x] == TALL_GRASS || cur->board[random_y][random_x] == PATH))
                 {
-                    world[y][x]->board[random_y][random_x] = RIVAL;
+                    add_trainer(cur, random_x, random_y, RIVAL, x, y);
                 }
             }
         }
     } else if (flying == 1){
-        int buildingOffset = rand() % 4;
-        int randTop = rand() % (world[y][x]->VB - 1) + 1;
-        int randLeft = rand() % (world[y][x]->HB - 1) + 1;
-        int randBottom = rand() % (HEIGHT - 1 - world[y][x]->VB) - 1;
-        int randRight = rand() % (WIDTH - 1 - world[y][x]->HB) - 1;
-        int l = 1, m = 1;
+        // Land on a road cell of the existing map, trying again while a trainer stands there
+        int landX = -1, landY = -1;
+        do {
+            int buildingOffset = next_random(RNG_WORLD) % 4;
+            int randTop = next_random(RNG_WORLD) % (cur->VB - 1) + 1;
+            int randLeft = next_random(RNG_WORLD) % (cur->HB - 1) + 1;
+            int randBottom = next_random(RNG_WORLD) % (HEIGHT - 1 - cur->VB) - 1;
+            int randRight = next_random(RNG_WORLD) % (WIDTH - 1 - cur->HB) - 1;
+            int l = 1, m = 1;
 
-        if ((x == MAP_CENTER && y == MAP_CENTER) || (flying == 1)){
             if (buildingOffset == 0)
             {
-                while (world[y][x]->board[world[y][x]->West][randLeft + m] != PATH)
+                while (cur->board[cur->West][randLeft + m] != PATH)
                 {
                     m--;
                 }
-                world[y][x]->board[world[y][x]->West][randLeft + m] = PC;
+                landX = randLeft + m;
+                landY = cur->West;
             }
             else if (buildingOffset == 1)
             {
-                while (world[y][x]->board[world[y][x]->East][world[y][x]->HB + randRight + m] != PATH)
+                while (cur->board[cur->East][cur->HB + randRight + m] != PATH)
                 {
                     m++;
                 }
-                world[y][x]->board[world[y][x]->East][world[y][x]->HB + randRight + m] = PC;
+                landX = cur->HB + randRight + m;
+                landY = cur->East;
             }
             else if (buildingOffset == 2)
             {
-                while (world[y][x]->board[randTop + l][world[y][x]->North] != PATH)
+                while (cur->board[randTop + l][cur->North] != PATH)
                 {
                     l--;
                 }
-                world[y][x]->board[randTop + l][world[y][x]->North] = PC;
+                landX = cur->North;
+                landY = randTop + l;
             }
             else if (buildingOffset == 3)
             {
-                while (world[y][x]->board[world[y][x]->VB + randBottom + l][world[y][x]->South] != PATH)
+                while (cur->board[cur->VB + randBottom + l][cur->South] != PATH)
                 {
                     l++;
                 }
-                world[y][x]->board[world[y][x]->VB + randBottom + l][world[y][x]->South] = PC;
+                landX = cur->South;
+                landY = cur->VB + randBottom + l;
             }
-        }
+        } while (is_occupied(cur, landX, landY));
+        place_pc(cur, landX, landY);
     }
+
+    return cur;
 }
 
-void displayMap(map *world[MAP_SIZE][MAP_SIZE], int x, int y) {
+void displayMap(map *cur) {
     int i, j;
 
     start_color(); // Initialize color functionality
@@ -1768,143 +3588,178 @@ void displayMap(map *world[MAP_SIZE][MAP_SIZE], int x, int y) {
     {
         for (j = 0; j < WIDTH; ++j)
         {   
-            if (world[y][x]->board[i][j] == GRASS) {
+            if (cur->board[i][j] == GRASS) {
                 attron(COLOR_PAIR(1)); // Turn on color pair
-                mvprintw(i + 1, j, "%c", world[y][x]->board[i][j]); // Move and print each character
+                mvprintw(i + 1, j, "%c", cur->board[i][j]); // Move and print each character
                 attroff(COLOR_PAIR(1)); // Turn off color pair
-            } else if (world[y][x]->board[i][j] == TALL_GRASS) {
+            } else if (cur->board[i][j] == TALL_GRASS) {
                 attron(COLOR_PAIR(2)); // Turn on color pair
-                mvprintw(i + 1, j, "%c", world[y][x]->board[i][j]); // Move and print each character
+                mvprintw(i + 1, j, "%c", cur->board[i][j]); // Move and print each character
                 attroff(COLOR_PAIR(2)); // Turn off color pair
-            } else if (world[y][x]->board[i][j] == TREE) {
+            } else if (cur->board[i][j] == TREE) {
                 attron(COLOR_PAIR(3)); // Turn on color pair
-                mvprintw(i + 1, j, "%c", world[y][x]->board[i][j]); // Move and print each character
+                mvprintw(i + 1, j, "%c", cur->board[i][j]); // Move and print each character
                 attroff(COLOR_PAIR(3)); // Turn off color pair
-            } else if (world[y][x]->board[i][j] == WATER) {
+            } else if (cur->board[i][j] == WATER) {
                 attron(COLOR_PAIR(4)); // Turn on color pair
-                mvprintw(i + 1, j, "%c", world[y][x]->board[i][j]); // Move and print each character
+                mvprintw(i + 1, j, "%c", cur->board[i][j]); // Move and print each character
                 attroff(COLOR_PAIR(4)); // Turn off color pair
-            } else if (world[y][x]->board[i][j] == PATH) {
+            } else if (cur->board[i][j] == PATH) {
                 attron(COLOR_PAIR(5)); // Turn on color pair
-                mvprintw(i + 1, j, "%c", world[y][x]->board[i][j]); // Move and print each character
+                mvprintw(i + 1, j, "%c", cur->board[i][j]); // Move and print each character
                 attroff(COLOR_PAIR(5)); // Turn off color pair
-            } else if (world[y][x]->board[i][j] == BORDER) {
+            } else if (cur->board[i][j] == BORDER) {
                 attron(COLOR_PAIR(6)); // Turn on color pair
-                mvprintw(i + 1, j, "%c", world[y][x]->board[i][j]); // Move and print each character
+                mvprintw(i + 1, j, "%c", cur->board[i][j]); // Move and print each character
                 attroff(COLOR_PAIR(6)); // Turn off color pair
-            } else if (world[y][x]->board[i][j] == WANDERER || world[y][x]->board[i][j] == EXPLORER || world[y][x]->board[i][j] == RIVAL || world[y][x]->board[i][j] == PACER || world[y][x]->board[i][j] == HIKER || world[y][x]->board[i][j] == SENTRY) {
-                attron(COLOR_PAIR(7)); // Turn on color pair
-                mvprintw(i + 1, j, "%c", world[y][x]->board[i][j]); // Move and print each character
-                attroff(COLOR_PAIR(7)); // Turn off color pair
-            } else if (world[y][x]->board[i][j] == PC) {
-                attron(COLOR_PAIR(8)); // Turn on color pair
-                mvprintw(i + 1, j, "%c", world[y][x]->board[i][j]); // Move and print each character
-                attroff(COLOR_PAIR(8)); // Turn off color pair
-            } else if (world[y][x]->board[i][j] == POKEMART || world[y][x]->board[i][j] == POKEMON_CENTER) {
+            } else if (cur->board[i][j] == POKEMART || cur->board[i][j] == POKEMON_CENTER) {
                 attron(COLOR_PAIR(9)); // Turn on color pair
-                mvprintw(i + 1, j, "%c", world[y][x]->board[i][j]); // Move and print each character
+                mvprintw(i + 1, j, "%c", cur->board[i][j]); // Move and print each character
                 attroff(COLOR_PAIR(9)); // Turn off color pair
             }
         }
     }
-    refresh();
+
+    // Draw the trainers and the PC over the terrain
+    attron(COLOR_PAIR(7));
+    for (i = 0; i < cur->npcs.size(); ++i)
+    {
+        mvprintw(cur->npcs.y[i] + 1, cur->npcs.x[i], "%c", cur->npcs.type[i]);
+    }
+    attroff(COLOR_PAIR(7));
+    if (cur->pcX != -1)
+    {
+        attron(COLOR_PAIR(8));
+        mvprintw(cur->pcY + 1, cur->pcX, "%c", PC);
+        attroff(COLOR_PAIR(8));
+    }
+    refresh();
+}
+
+// Moves trainer i to (nextX, nextY). The cost is charged by run_npc_turns.
+void move_npc_to(map *cur, int i, int nextX, int nextY) {
+    NPCStore &npcs = cur->npcs;
+    cur->occupant[nextY][nextX] = i; // Place the NPC at the new position
+    cur->occupant[npcs.y[i]][npcs.x[i]] = NO_OCCUPANT;
+    npcs.x[i] = nextX;
+    npcs.y[i] = nextY;
+}
+
+// Steps a hiker or rival to the free neighboring cell closest to the PC on its distance map.
+void step_toward_pc(map *cur, int i, int (*dist)[WIDTH]) {
+    NPCStore &npcs = cur->npcs;
+    int minCost = SHRT_MAX;
+    int nextX = npcs.x[i];
+    int nextY = npcs.y[i];
+
+    for (int direction = 0; direction < 8; direction++) {
+        int newX = npcs.x[i] + npc_dx[direction];
+        int newY = npcs.y[i] + npc_dy[direction];
+
+        // Check if the new position is within the map boundaries and not occupied by the PC or another NPC
+        if (newX > 0 && newX < WIDTH - 1 && newY > 0 && newY < HEIGHT - 1 && !is_occupied(cur, newX, newY) && dist[newY][newX] < minCost) {
+            minCost = dist[newY][newX];
+            nextX = newX;
+            nextY = newY;
+        }
+    }
+    if (nextX != npcs.x[i] || nextY != npcs.y[i]) {
+        move_npc_to(cur, i, nextX, nextY);
+    }
 }
 
-void move_npc(NPC *npc, map *world[MAP_SIZE][MAP_SIZE], int x, int y, int hikerDist[HEIGHT][WIDTH], int rivalDist[HEIGHT][WIDTH]) {
-    int dx[] = {-1, -1, -1, 0, 1, 1, 1, 0};
-    int dy[] = {-1, 0, 1, 1, 1, 0, -1, -1};
-    
-    if ((npc->type == PACER || npc->type == WANDERER || npc->type == EXPLORER) && npc->is_direction_initialized != 1) {
-        // Initialize the direction randomly
-        int random_direction = rand() % 8;
-        npc->dx = dx[random_direction];
-        npc->dy = dy[random_direction];
-        npc->is_direction_initialized = 1;
+// Walks a pacer straight ahead, turning around when blocked.
+void step_pacer(map *cur, int i) {
+    NPCStore &npcs = cur->npcs;
+    int newX = npcs.x[i] + npcs.dx[i];
+    int newY = npcs.y[i] + npcs.dy[i];
+
+    if (cur->board[newY][newX] != BORDER && cur->board[newY][newX] != TREE && cur->board[newY][newX] != WATER && !is_gate(cur->board, newX, newY) && !is_occupied(cur, newX, newY)) {
+        move_npc_to(cur, i, newX, newY);
+    } else {
+        npcs.dx[i] = -npcs.dx[i];
+        npcs.dy[i] = -npcs.dy[i];
     }
-    
-    int minCost = SHRT_MAX;
-    int nextX = npc->x;
-    int nextY = npc->y;
-
-    if (npc->is_defeated == false) {
-        if(npc->type == HIKER || npc->type == RIVAL){
-            for (int direction = 0; direction < 8; direction++) {
-                int newX = npc->x + dx[direction];
-                int newY = npc->y + dy[direction];
-
-                // Check if the new position is within the map boundaries and not occupied by the PC or another NPC
-                if (newX > 0 && newX < WIDTH - 1 && newY > 0 && newY < HEIGHT - 1 && world[y][x]->board[newY][newX] != PC && world[y][x]->board[newY][newX] != HIKER && world[y][x]->board[newY][newX] != RIVAL && world[y][x]->board[newY][newX] != PACER && world[y][x]->board[newY][newX] != WANDERER && world[y][x]->board[newY][newX] != SENTRY && world[y][x]->board[newY][newX] != EXPLORER) {
-                    int cost;
-                    if (npc->type == HIKER) {
-                        cost = hikerDist[newY][newX];
-                    } else {
-                        cost = rivalDist[newY][newX];
-                    }
+}
 
-                    if (cost < minCost) {
-                        minCost = cost;
-                        nextX = newX;
-                        nextY = newY;
-                    }
-                }
-            }
-        } else if (npc->type == PACER) {
-            int newX = npc->x + npc->dx;
-            int newY = npc->y + npc->dy;
-            
-            if (world[y][x]->board[newY][newX] != BORDER && world[y][x]->board[newY][newX] != TREE && world[y][x]->board[newY][newX] != WATER && !is_gate(worldMap[y][x], newX, newY) && world[y][x]->board[newY][newX] != PC && world[y][x]->board[newY][newX] != HIKER && world[y][x]->board[newY][newX] != RIVAL && world[y][x]->board[newY][newX] != PACER && world[y][x]->board[newY][newX] != WANDERER && world[y][x]->board[newY][newX] != SENTRY && world[y][x]->board[newY][newX] != EXPLORER) {
-                nextX = newX;
-                nextY = newY;
-            } else {
-                npc->dx *= -1;
-                npc->dy *= -1;
-            }
-        } else if (npc->type == WANDERER) {
-            int newX = npc->x + npc->dx;
-            int newY = npc->y + npc->dy;
-            int tries = 0;
+// Checks if a wanderer (stays on the terrain it stands on) or an explorer (goes anywhere walkable)
+// standing at (fromX, fromY) may step onto (x, y).
+bool roamer_can_enter(map *cur, bool wanderer, int fromX, int fromY, int x, int y) {
+    if (cur->board[y][x] == BORDER || is_gate(cur->board, x, y) || is_occupied(cur, x, y)) {
+        return false;
+    }
+    if (wanderer) {
+        return cur->board[y][x] == cur->board[fromY][fromX];
+    }
+    return cur->board[y][x] != TREE && cur->board[y][x] != WATER;
+}
 
-            while (tries < 8 && ((firstLayer[y][x]->board[newY][newX] != firstLayer[y][x]->board[npc->y][npc->x]) || is_gate(worldMap[y][x], newX, newY) || world[y][x]->board[newY][newX] == BORDER || world[y][x]->board[newY][newX] == PC || world[y][x]->board[newY][newX] == HIKER || world[y][x]->board[newY][newX] == RIVAL || world[y][x]->board[newY][newX] == PACER || world[y][x]->board[newY][newX] == WANDERER || world[y][x]->board[newY][newX] == SENTRY || world[y][x]->board[newY][newX] == EXPLORER)) {
-                int random_direction = rand() % 8;
-                npc->dx = dx[random_direction];
-                npc->dy = dy[random_direction];
-                newX = npc->x + npc->dx;
-                newY = npc->y + npc->dy;
-                tries++;
-            }
+// Walks a wanderer or explorer ahead, picking random new directions while blocked and giving up for
+// this turn after 8 tries.
+void step_roamer(map *cur, int i) {
+    NPCStore &npcs = cur->npcs;
+    bool wanderer = npcs.type[i] == WANDERER;
+    int newX = npcs.x[i] + npcs.dx[i];
+    int newY = npcs.y[i] + npcs.dy[i];
+    int tries = 0;
+
+    while (tries < 8 && !roamer_can_enter(cur, wanderer, npcs.x[i], npcs.y[i], newX, newY)) {
+        int random_direction = next_random(RNG_NPCS) % 8;
+        npcs.dx[i] = npc_dx[random_direction];
+        npcs.dy[i] = npc_dy[random_direction];
+        newX = npcs.x[i] + npcs.dx[i];
+        newY = npcs.y[i] + npcs.dy[i];
+        tries++;
+    }
 
-            if (tries < 8) {
-                nextX = newX;
-                nextY = newY;
-            }
-        } else if (npc->type == EXPLORER) {
-            int newX = npc->x + npc->dx;
-            int newY = npc->y + npc->dy;
-            int tries = 0;
+    if (tries < 8) {
+        move_npc_to(cur, i, newX, newY);
+    }
+}
 
-            while (tries < 8 && ((world[y][x]->board[newY][newX] == BORDER || world[y][x]->board[newY][newX] == TREE || world[y][x]->board[newY][newX] == WATER) || (is_gate(worldMap[y][x], newX, newY) || world[y][x]->board[newY][newX] == PC || world[y][x]->board[newY][newX] == HIKER || world[y][x]->board[newY][newX] == RIVAL || world[y][x]->board[newY][newX] == PACER || world[y][x]->board[newY][newX] == WANDERER || world[y][x]->board[newY][newX] == SENTRY || world[y][x]->board[newY][newX] == EXPLORER))) {
-                int random_direction = rand() % 8;
-                npc->dx = dx[random_direction];
-                npc->dy = dy[random_direction];
-                newX = npc->x + npc->dx;
-                newY = npc->y + npc->dy;
-                tries++;
-            }
+// Ends the PC's turn and takes every trainer turn due before its next one, in (time, seq) order, then
+// starts the PC's next turn. Only trainers whose turn is due are touched, so this scales with the number
+// of due trainers rather than the number on the map. Every turn, the PC's included, is charged the cost
+// of the cell the actor ends it on, so a trainer that could not move waits out the cost of its cell.
+void run_npc_turns(map *cur, DistanceMaps *distances) {
+    NPCStore &npcs = cur->npcs;
+    TurnQueue &turns = cur->turns;
+
+    if (turns.pcSeq == PC_ACTING) {
+        turns.pcSeq = schedule_turn(cur, turns.now + movement_costs(cur, PC)[cur->pcY][cur->pcX], PC_OCCUPANT);
+    }
 
-            if (tries < 8) {
-                nextX = newX;
-                nextY = newY;
+    while (!turns.heap.empty()) {
+        TurnEvent turn = turn_pop(&turns);
+
+        if (turn.actor == PC_OCCUPANT) {
+            if (turn.seq == turns.pcSeq) {
+                turns.now = turn.time;
+                turns.pcSeq = PC_ACTING;
+                return;
             }
+            continue; // Left behind by an earlier visit of the PC
+        }
+
+        int i = turn.actor;
+        turns.now = turn.time;
+        if (npcs.defeated[i]) {
+            continue;
         }
 
-        // Update the NPC's position
-        if (nextX != npc->x || nextY != npc->y) {
-            world[y][x]->board[npc->y][npc->x] = firstLayer[y][x]->board[npc->y][npc->x]; // Replace the old position with grass
-            npc->x = nextX;
-            npc->y = nextY;
-            npc->cost = npc->cost + get_movement_cost(world[y][x], nextX, nextY, npc->type);
-            world[y][x]->board[nextY][nextX] = npc->type; // Place the NPC at the new position
+        int layer = pathing_layer(npcs.type[i]);
+        if (layer != -1) {
+            step_toward_pc(cur, i, distances->dist[layer]);
+        } else if (npcs.type[i] == PACER) {
+            step_pacer(cur, i);
+        } else {
+            step_roamer(cur, i);
         }
+
+        int cost = movement_costs(cur, npcs.type[i])[npcs.y[i]][npcs.x[i]];
+        assert(cost != SHRT_MAX);
+        npcs.cost[i] = turns.now + cost;
+        schedule_turn(cur, npcs.cost[i], i);
     }
 }
 
@@ -1967,22 +3822,20 @@ void handleGameOver(std::vector<PokemonWithMoves>& pcPokemons) {
 
 
 int findGrowthRateId(int speciesId) {
-    for (const auto& species : allPokemonSpecies) {
-        if (species.id == speciesId) {
-            return species.growth_rate_id;
-        }
+    if (speciesId < 0 || speciesId >= (int) pokedex.speciesRow.size() || pokedex.speciesRow[speciesId] == -1) {
+        return -1; // Return an invalid ID if not found
     }
-    return -1; // Return an invalid ID if not found
+    return allPokemonSpecies[pokedex.speciesRow[speciesId]].growth_rate_id;
 }
 
 int experienceNeeded(int currentLevel, int speciesId) {
     int growthRateId = findGrowthRateId(speciesId);
-    for (const auto& exp : allExperiences) {
-        if (exp.growth_rate_id == growthRateId && exp.level == currentLevel + 1) {
-            return exp.experience;
-        }
+    int level = currentLevel + 1;
+    if (growthRateId < 0 || growthRateId >= (int) pokedex.experience.size() || level < 0 ||
+        level >= (int) pokedex.experience[growthRateId].size()) {
+        return INT_MAX; // If not found, return a large number to prevent leveling up
     }
-    return INT_MAX; // If not found, return a large number to prevent leveling up
+    return pokedex.experience[growthRateId][level];
 }
 
 void levelUp(PokemonWithMoves* pokemon) {
@@ -1999,7 +3852,7 @@ void levelUp(PokemonWithMoves* pokemon) {
     pokemon->hp = pokemon->max_hp / 5; // Heal Pokémon to full health on level up
 
     // Update the experience needed for the next level
-    pokemon->next_level_exp = experienceNeeded(pokemon->level, pokemon->pokemon.species_id);
+    pokemon->next_level_exp = experienceNeeded(pokemon->level, pokemon->species_id);
     
     // Check if level is maxed out and handle accordingly
     if (pokemon->level >= 100) {
@@ -2007,7 +3860,7 @@ void levelUp(PokemonWithMoves* pokemon) {
     }
 
     clear();
-    mvprintw(0, 0, "%s grew to level %d!", pokemon->pokemon.identifier.c_str(), pokemon->level);
+    mvprintw(0, 0, "%s grew to level %d!", name_of(pokemon->identifier), pokemon->level);
     refresh();
 }
 
@@ -2016,13 +3869,14 @@ void showPokemonList() {
     clear();
     mvprintw(0, 0, "Your Pokemons:");
     for (size_t i = 0; i < pcPokemons.size(); ++i) {
-        mvprintw(static_cast<int>(i) + 1, 0, "%d. %s (HP: %d/%d) %s", static_cast<int>(i + 1), pcPokemons[i].pokemon.identifier.c_str(), pcPokemons[i].hp, pcPokemons[i].max_hp, pcPokemons[i].is_knocked_out ? "(Knocked out)" : "");
+        mvprintw(static_cast<int>(i) + 1, 0, "%d. %s (HP: %d/%d) %s", static_cast<int>(i + 1), name_of(pcPokemons[i].identifier), pcPokemons[i].hp, pcPokemons[i].max_hp, pcPokemons[i].is_knocked_out ? "(Knocked out)" : "");
     }
     refresh();
 }
 
-void checkBattleOutcome(NPC* npc, int& currentLine) {
-    bool allKnockedOut = std::all_of(npc->pokemons.begin(), npc->pokemons.end(), [](const PokemonWithMoves& mon) { return mon.is_knocked_out; });
+void checkBattleOutcome(NPCStore* npcs, int id, int& currentLine) {
+    Team team = npcs->team(id);
+    bool allKnockedOut = std::all_of(team.begin(), team.end(), [](const PokemonWithMoves& mon) { return mon.is_knocked_out; });
     if (allKnockedOut) {
         mvprintw(currentLine++, 0, "You have defeated the trainer!");
     } else {
@@ -2039,60 +3893,61 @@ int determinePokemonLevel(int curX, int curY) {
     if (man_distance <= 1) {
         level = 1;
     } else if (man_distance > 200) {
-        level = (rand() % (int)((100 - ((man_distance - 200) / 2) + 1)) + ((man_distance - 200) / 2));
+        level = (next_random(RNG_TRAINERS) % (int)((100 - ((man_distance - 200) / 2) + 1)) + ((man_distance - 200) / 2));
     } else {
-        level = (rand() % (int)(man_distance / 2)) + 1;
+        level = (next_random(RNG_TRAINERS) % (int)(man_distance / 2)) + 1;
     }
 
     return level;
 }
 
 PokemonWithMoves generateRandomPokemonWithMoves(int curX, int curY, int habitatId) {
-    std::vector<PokemonSpecies> habitatFilteredSpecies;
+    // Count the species of this habitat in place, without copying them out
+    int numHabitatSpecies = 0;
     if (habitatId != -1) {
-        // Filter Pokemon species by habitat
         for (const auto& species : allPokemonSpecies) {
-            if (species.habitat_id == habitatId) {
-                habitatFilteredSpecies.push_back(species);
-            }
+            numHabitatSpecies += species.habitat_id == habitatId;
         }
     }
 
-    // If no species are found for this habitat or habitatId is -1, default to using all species
-    if (habitatFilteredSpecies.empty()) {
-        habitatFilteredSpecies = allPokemonSpecies;
+    // Select a random species of the habitat, or of all species if none are found for it or habitatId is -1
+    int random_species_index;
+    int species_id;
+    if (numHabitatSpecies == 0) {
+        random_species_index = next_random(RNG_TRAINERS) % allPokemonSpecies.size();
+        species_id = allPokemonSpecies[random_species_index].id;
+    } else {
+        random_species_index = next_random(RNG_TRAINERS) % numHabitatSpecies;
+        int seen = 0;
+        species_id = -1;
+        for (const auto& species : allPokemonSpecies) {
+            if (species.habitat_id == habitatId && seen++ == random_species_index) {
+                species_id = species.id;
+                break;
+            }
+        }
     }
 
-    // Now select a random Pokémon species from the filtered list
-    int random_species_index = rand() % habitatFilteredSpecies.size();
-    int species_id = habitatFilteredSpecies[random_species_index].id;
-
     PokemonWithMoves newPokemon;
-    newPokemon.pokemon = allPokemons[random_species_index];
+    setPokemon(&newPokemon, allPokemons[random_species_index]);
 
-    int IV_hp = rand() % 16;
-    int IV_attack = rand() % 16;
-    int IV_defense = rand() % 16;
-    //int IV_special_attack = rand() % 16;
-    //int IV_special_defense = rand() % 16;
-    int IV_speed = rand() % 16;
+    int IV_hp = next_random(RNG_TRAINERS) % 16;
+    int IV_attack = next_random(RNG_TRAINERS) % 16;
+    int IV_defense = next_random(RNG_TRAINERS) % 16;
+    //int IV_special_attack = next_random(RNG_TRAINERS) % 16;
+    //int IV_special_defense = next_random(RNG_TRAINERS) % 16;
+    int IV_speed = next_random(RNG_TRAINERS) % 16;
 
     // Determine the level of the Pokémon based on the distance
     newPokemon.level = determinePokemonLevel(curX, curY);
 
-    int base_hp, base_attack, base_defense, /*base_special_attack, base_special_defense,*/ base_speed;
-    for (const auto& stat : allPokemonStats) {
-        if (stat.pokemon_id == species_id) {
-            switch (stat.stat_id) {
-                case 1: base_hp = stat.base_stat; break;
-                case 2: base_attack = stat.base_stat; break;
-                case 3: base_defense = stat.base_stat; break;
-                //case 4: base_special_attack = stat.base_stat; break;
-                //case 5: base_special_defense = stat.base_stat; break;
-                case 6: base_speed = stat.base_stat; break;
-            }
-        }
-    }
+    const BaseStats& base = baseStatsOf(species_id);
+    int base_hp = base.stat[STAT_HP];
+    int base_attack = base.stat[STAT_ATTACK];
+    int base_defense = base.stat[STAT_DEFENSE];
+    //int base_special_attack = base.stat[STAT_SPECIAL_ATTACK];
+    //int base_special_defense = base.stat[STAT_SPECIAL_DEFENSE];
+    int base_speed = base.stat[STAT_SPEED];
 
     int hp = ((base_hp + IV_hp) * 2 * newPokemon.level) / 100 + newPokemon.level + 10;
     int attack = ((base_attack + IV_attack) * 2 * newPokemon.level) / 100 + 5;
@@ -2107,28 +3962,18 @@ PokemonWithMoves generateRandomPokemonWithMoves(int curX, int curY, int habitatI
     newPokemon.defense = defense;
     newPokemon.speed = speed;
     newPokemon.is_knocked_out = false;
-    newPokemon.is_burned = 0;
-    newPokemon.is_paralyzed = 0;
-    newPokemon.is_poisoned = 0;
-    newPokemon.is_asleep = 0;
-    newPokemon.is_confused = 0;
-    newPokemon.is_frozen = 0;
+    newPokemon.status = STATUS_NONE;
+    newPokemon.statusTurns = 0;
     newPokemon.current_exp = 0;
-    newPokemon.next_level_exp = experienceNeeded(newPokemon.level, newPokemon.pokemon.species_id);
-
-    for (const auto& pokemon_move : allPokemonMoves) {
-            if (pokemon_move.pokemon_id == species_id && pokemon_move.level <= newPokemon.level) {
-                for (const auto& move : allMoves) {
-                    if (move.id == pokemon_move.move_id) {
-                        newPokemon.moves.push_back(move.identifier);
-                        break;
-                    }
-                }
-                if (newPokemon.moves.size() >= 2) {
-                    break; // Limit to 2 moves
-                }
-            }
+    newPokemon.next_level_exp = experienceNeeded(newPokemon.level, newPokemon.species_id);
+
+    newPokemon.numMoves = 0;
+    LearnsetSlice learnable = learnableMoves(species_id, newPokemon.level);
+    for (int row = learnable.begin; row < learnable.end && newPokemon.numMoves < 2; row++) { // Limit to 2 moves
+        if (pokedex.learnMoveRow[row] != -1) {
+            add_move(&newPokemon, pokedex.learnMoveId[row]);
         }
+    }
 
     return newPokemon;
 }
@@ -2136,32 +3981,26 @@ PokemonWithMoves generateRandomPokemonWithMoves(int curX, int curY, int habitatI
 void chooseStartingPokemon() {
     // Generate three random level 1 Pokémon for the player to choose from
     std::vector<PokemonWithMoves> options;
-    int IV_hp = rand() % 16;
-    int IV_attack = rand() % 16;
-    int IV_defense = rand() % 16;
-    //int IV_special_attack = rand() % 16;
-    //int IV_special_defense = rand() % 16;
-    int IV_speed = rand() % 16;
+    int IV_hp = next_random(RNG_POKEMON) % 16;
+    int IV_attack = next_random(RNG_POKEMON) % 16;
+    int IV_defense = next_random(RNG_POKEMON) % 16;
+    //int IV_special_attack = next_random(RNG_POKEMON) % 16;
+    //int IV_special_defense = next_random(RNG_POKEMON) % 16;
+    int IV_speed = next_random(RNG_POKEMON) % 16;
     for (int i = 0; i < 3; ++i) {
-        int random_species_index = rand() % allPokemonSpecies.size();
+        int random_species_index = next_random(RNG_POKEMON) % allPokemonSpecies.size();
         int species_id = allPokemonSpecies[random_species_index].id;
 
         PokemonWithMoves newPokemon;
-        newPokemon.pokemon = allPokemons[random_species_index];
+        setPokemon(&newPokemon, allPokemons[random_species_index]);
         newPokemon.level = 1;
-        int base_hp, base_attack, base_defense, /*base_special_attack, base_special_defense,*/ base_speed;
-        for (const auto& stat : allPokemonStats) {
-            if (stat.pokemon_id == species_id) {
-                switch (stat.stat_id) {
-                    case 1: base_hp = stat.base_stat; break;
-                    case 2: base_attack = stat.base_stat; break;
-                    case 3: base_defense = stat.base_stat; break;
-                    //case 4: base_special_attack = stat.base_stat; break;
-                    //case 5: base_special_defense = stat.base_stat; break;
-                    case 6: base_speed = stat.base_stat; break;
-                }
-            }
-        }
+        const BaseStats& base = baseStatsOf(species_id);
+        int base_hp = base.stat[STAT_HP];
+        int base_attack = base.stat[STAT_ATTACK];
+        int base_defense = base.stat[STAT_DEFENSE];
+        //int base_special_attack = base.stat[STAT_SPECIAL_ATTACK];
+        //int base_special_defense = base.stat[STAT_SPECIAL_DEFENSE];
+        int base_speed = base.stat[STAT_SPEED];
 
         int hp = ((base_hp + IV_hp) * 2 * newPokemon.level) / 100 + newPokemon.level + 10;
         int attack = ((base_attack + IV_attack) * 2 * newPokemon.level) / 100 + 5;
@@ -2176,27 +4015,17 @@ void chooseStartingPokemon() {
         newPokemon.defense = defense;
         newPokemon.speed = speed;
         newPokemon.is_knocked_out = false;
-        newPokemon.is_burned = 0;
-        newPokemon.is_paralyzed = 0;
-        newPokemon.is_poisoned = 0;
-        newPokemon.is_asleep = 0;
-        newPokemon.is_confused = 0;
-        newPokemon.is_frozen = 0;
+        newPokemon.status = STATUS_NONE;
+        newPokemon.statusTurns = 0;
         newPokemon.current_exp = 0;
-        newPokemon.next_level_exp = experienceNeeded(newPokemon.level, newPokemon.pokemon.species_id);
+        newPokemon.next_level_exp = experienceNeeded(newPokemon.level, newPokemon.species_id);
 
         // Find moves for the Pokémon that it can learn at level 1
-        for (const auto& pokemon_move : allPokemonMoves) {
-            if (pokemon_move.pokemon_id == species_id && pokemon_move.level == 1) {
-                for (const auto& move : allMoves) {
-                    if (move.id == pokemon_move.move_id) {
-                        newPokemon.moves.push_back(move.identifier);
-                        break;
-                    }
-                }
-                if (newPokemon.moves.size() >= 2) {
-                    break; // Limit to 2 moves
-                }
+        newPokemon.numMoves = 0;
+        LearnsetSlice learnable = learnsetBetween(species_id, 1, 1);
+        for (int row = learnable.begin; row < learnable.end && newPokemon.numMoves < 2; row++) { // Limit to 2 moves
+            if (pokedex.learnMoveRow[row] != -1) {
+                add_move(&newPokemon, pokedex.learnMoveId[row]);
             }
         }
 
@@ -2209,9 +4038,9 @@ void chooseStartingPokemon() {
     mvprintw(0, 0, "Choose your starting Pokemon:");
     int currentLine = 1; // Keep track of the current line for printing
     for (size_t i = 0; i < options.size(); ++i) {
-        mvprintw(currentLine++, 0, "%d. %s", static_cast<int>(i + 1), options[i].pokemon.identifier.c_str());
-        for (size_t j = 0; j < options[i].moves.size(); ++j) {
-            mvprintw(currentLine++, 4, "- %s", options[i].moves[j].c_str());
+        mvprintw(currentLine++, 0, "%d. %s", static_cast<int>(i + 1), name_of(options[i].identifier));
+        for (int j = 0; j < options[i].numMoves; ++j) {
+            mvprintw(currentLine++, 4, "- %s", move_name(options[i].moves[j]));
             
         }
     }
@@ -2227,93 +4056,64 @@ void chooseStartingPokemon() {
     pcPokemons.push_back(options[choice - 1]);
 }
 
-Move* findMove(const std::string& moveName) {
-    for (auto& move : allMoves) {
-        //std::cerr << "Checking move: " << move.identifier << " against " << moveName << "\n";
-        if (move.identifier == moveName) {
-            return &move;
-        }
-    }
-    //std::cerr << "Move not found: " << moveName << "\n";
-    return nullptr;
+void resetStatusEffects(PokemonWithMoves* pokemon) {
+    pokemon->status = STATUS_NONE;
+    pokemon->statusTurns = 0;
 }
 
-void resetStatusEffects(PokemonWithMoves* pokemon) {
-    pokemon->is_asleep = 0;
-    pokemon->is_burned = 0;
-    pokemon->is_confused = 0;
-    pokemon->is_frozen = 0;
-    pokemon->is_paralyzed = 0;
-    pokemon->is_poisoned = 0;
+// Returns whether a Pokemon has had a status for at least turns turns; see Status.
+bool hasStatus(const PokemonWithMoves* pokemon, Status status, int turns) {
+    return pokemon->status == status && pokemon->statusTurns >= turns;
+}
+
+// Takes damage off a Pokemon's HP, stopping at 0.
+void takeDamage(PokemonWithMoves* pokemon, int damage) {
+    pokemon->hp = damage >= pokemon->hp ? 0 : pokemon->hp - damage;
 }
 
 void executeMove(PokemonWithMoves* attacker, PokemonWithMoves* defender, int moveIndex) {
     clear();
     int currentLine = 0;
-    if (moveIndex >= 0 && static_cast<size_t>(moveIndex) < attacker->moves.size()) {
-        std::string moveName = attacker->moves[moveIndex];
-        Move* selectedMove = findMove(moveName);
+    if (moveIndex >= 0 && moveIndex < attacker->numMoves) {
+        Move* selectedMove = moveById(attacker->moves[moveIndex]);
         
         if (selectedMove) {
-            if (rand() % 100 < selectedMove->accuracy) {
+            if (next_random(RNG_BATTLE) % 100 < selectedMove->accuracy) {
                 int attack = attacker->attack; 
                 int defense = defender->defense;
                 int level = attacker->level;
                 int power = selectedMove->power;
-                float random = static_cast<float>(rand() % 16 + 85) / 100.0f;
-                float stab = 1.0;
-                for (const auto& pokemonType : allPokemonTypes) {
-                    if (pokemonType.pokemon_id == attacker->pokemon.id && pokemonType.type_id == selectedMove->type_id) {
-                        stab = 1.5;
-                        break;
-                    }
-                }
+                float random = static_cast<float>(next_random(RNG_BATTLE) % 16 + 85) / 100.0f;
+                float stab = (typeMaskOf(attacker->pokemon_id) & typeBit(selectedMove->type_id)) ? 1.5f : 1.0f;
                 // Calculate critical hit
-                float critical = (rand() % 256) < (attacker->speed / 2) ? 1.5f : 1.0f;
-                float type = 1.0;
+                float critical = (next_random(RNG_BATTLE) % 256) < (attacker->speed / 2) ? 1.5f : 1.0f;
+                float type = typeEffectiveness(selectedMove->type_id, typeMaskOf(defender->pokemon_id)) / 100.0f;
                 int damage = static_cast<int>((2 * level / 5 + 2) * power * attack / defense / 50 + 2) * critical * random * stab * type;
 
-                if (attacker->is_asleep == 1){
-                    resetStatusEffects(attacker);
-                    resetStatusEffects(defender);
-                    defender->is_asleep = 2;
-                } else if (attacker->is_burned == 1) {
-                    resetStatusEffects(attacker);
-                    resetStatusEffects(defender);
-                    defender->is_burned = 2;
-                } else if (attacker->is_confused == 1){
+                // A held item inflicts its status on the defender
+                if (attacker->status != STATUS_NONE && attacker->statusTurns == 1) {
+                    Status held = attacker->status;
                     resetStatusEffects(attacker);
                     resetStatusEffects(defender);
-                    defender->is_confused = 2;
-                } else if (attacker->is_frozen == 1){
-                    resetStatusEffects(attacker);
-                    resetStatusEffects(defender);
-                    defender->is_frozen = 2;
-                } else if (attacker->is_paralyzed == 1){
-                    resetStatusEffects(attacker);
-                    resetStatusEffects(defender);
-                    defender->is_paralyzed = 2;
-                } else if (attacker->is_poisoned == 1){
-                    resetStatusEffects(attacker);
-                    resetStatusEffects(defender);
-                    defender->is_poisoned = 2;
+                    defender->status = held;
+                    defender->statusTurns = 2;
                 }
 
                 int extraDamage = 0;
 
-                if (attacker->is_asleep >= 2) {
-                    attacker->is_asleep++;
-                } else if (defender->is_burned >= 2) {
-                    defender->is_burned++;
+                if (hasStatus(attacker, STATUS_ASLEEP, 2)) {
+                    attacker->statusTurns++;
+                } else if (hasStatus(defender, STATUS_BURNED, 2)) {
+                    defender->statusTurns++;
                     extraDamage = defender->max_hp / 8;
-                } else if (attacker->is_confused >= 2) {
-                    attacker->is_confused++;
-                } else if (attacker->is_frozen >= 2) {
-                    attacker->is_frozen++;
-                } else if (attacker->is_paralyzed >= 2) {
-                    attacker->is_paralyzed++;
-                } else if (defender->is_poisoned >= 2){
-                    defender->is_poisoned++;
+                } else if (hasStatus(attacker, STATUS_CONFUSED, 2)) {
+                    attacker->statusTurns++;
+                } else if (hasStatus(attacker, STATUS_FROZEN, 2)) {
+                    attacker->statusTurns++;
+                } else if (hasStatus(attacker, STATUS_PARALYZED, 2)) {
+                    attacker->statusTurns++;
+                } else if (hasStatus(defender, STATUS_POISONED, 2)){
+                    defender->statusTurns++;
                     extraDamage = defender->max_hp / 16;
                 }
 
@@ -2321,66 +4121,66 @@ void executeMove(PokemonWithMoves* attacker, PokemonWithMoves* defender, int mov
                     damage = 0;
                 }
                 
-                if (!(defender->is_burned >= 2 || defender->is_poisoned >= 2 || attacker->is_paralyzed >= 2 || attacker->is_frozen >= 2 || attacker->is_confused >= 2 || attacker->is_asleep >= 2)) {
-                    mvprintw(currentLine++, 0, "%s uses %s causing %d damage!", attacker->pokemon.identifier.c_str(), selectedMove->identifier.c_str(), damage);
-                } else if (defender->is_poisoned >= 2) {
-                    mvprintw(currentLine++, 0, "%s uses %s causing %d damage!", attacker->pokemon.identifier.c_str(), selectedMove->identifier.c_str(), damage);
+                if (!(hasStatus(defender, STATUS_BURNED, 2) || hasStatus(defender, STATUS_POISONED, 2) || hasStatus(attacker, STATUS_PARALYZED, 2) || hasStatus(attacker, STATUS_FROZEN, 2) || hasStatus(attacker, STATUS_CONFUSED, 2) || hasStatus(attacker, STATUS_ASLEEP, 2))) {
+                    mvprintw(currentLine++, 0, "%s uses %s causing %d damage!", name_of(attacker->identifier), name_of(selectedMove->identifier), damage);
+                } else if (hasStatus(defender, STATUS_POISONED, 2)) {
+                    mvprintw(currentLine++, 0, "%s uses %s causing %d damage!", name_of(attacker->identifier), name_of(selectedMove->identifier), damage);
                     damage += extraDamage;
-                    mvprintw(currentLine++, 0, "%s is poisoned, taking extra %d damage!", defender->pokemon.identifier.c_str(), extraDamage);
-                } else if (defender->is_burned >= 2) {
-                    mvprintw(currentLine++, 0, "%s uses %s causing %d damage!", attacker->pokemon.identifier.c_str(), selectedMove->identifier.c_str(), damage);
+                    mvprintw(currentLine++, 0, "%s is poisoned, taking extra %d damage!", name_of(defender->identifier), extraDamage);
+                } else if (hasStatus(defender, STATUS_BURNED, 2)) {
+                    mvprintw(currentLine++, 0, "%s uses %s causing %d damage!", name_of(attacker->identifier), name_of(selectedMove->identifier), damage);
                     damage += extraDamage;
-                    mvprintw(currentLine++, 0, "%s is burned, taking extra %d damage!", defender->pokemon.identifier.c_str(), extraDamage);
-                } else if (attacker->is_paralyzed >= 2) {
-                    if (rand() % 4 == 0) { // 25% chance to not move
+                    mvprintw(currentLine++, 0, "%s is burned, taking extra %d damage!", name_of(defender->identifier), extraDamage);
+                } else if (hasStatus(attacker, STATUS_PARALYZED, 2)) {
+                    if (next_random(RNG_BATTLE) % 4 == 0) { // 25% chance to not move
                         damage = 0;
-                        mvprintw(currentLine++, 0, "%s is paralyzed and can't move!", attacker->pokemon.identifier.c_str());
+                        mvprintw(currentLine++, 0, "%s is paralyzed and can't move!", name_of(attacker->identifier));
                     } else {
-                        mvprintw(currentLine++, 0, "%s uses %s causing %d damage!", attacker->pokemon.identifier.c_str(), selectedMove->identifier.c_str(), damage);
+                        mvprintw(currentLine++, 0, "%s uses %s causing %d damage!", name_of(attacker->identifier), name_of(selectedMove->identifier), damage);
                     }
-                } else if (attacker->is_frozen >= 2) {
+                } else if (hasStatus(attacker, STATUS_FROZEN, 2)) {
                     damage = 0;
-                    mvprintw(currentLine++, 0, "%s is frozen solid!", attacker->pokemon.identifier.c_str());
-                } else if (attacker->is_asleep >= 2) {
+                    mvprintw(currentLine++, 0, "%s is frozen solid!", name_of(attacker->identifier));
+                } else if (hasStatus(attacker, STATUS_ASLEEP, 2)) {
                     damage = 0;
-                    mvprintw(currentLine++, 0, "%s is asleep and can't attack!", attacker->pokemon.identifier.c_str());
-                } else if (attacker->is_confused >= 2) {
-                    if (rand() % 2 == 0) { // 50% chance to hurt itself
+                    mvprintw(currentLine++, 0, "%s is asleep and can't attack!", name_of(attacker->identifier));
+                } else if (hasStatus(attacker, STATUS_CONFUSED, 2)) {
+                    if (next_random(RNG_BATTLE) % 2 == 0) { // 50% chance to hurt itself
                         damage = attacker->level / 8; // Self-inflicted damage
-                        mvprintw(currentLine++, 0, "%s is confused and hurts itself with %d damage in its confusion!", attacker->pokemon.identifier.c_str(), damage);
+                        mvprintw(currentLine++, 0, "%s is confused and hurts itself with %d damage in its confusion!", name_of(attacker->identifier), damage);
                     } else {
-                        mvprintw(currentLine++, 0, "%s uses %s causing %d damage!", attacker->pokemon.identifier.c_str(), selectedMove->identifier.c_str(), damage);
+                        mvprintw(currentLine++, 0, "%s uses %s causing %d damage!", name_of(attacker->identifier), name_of(selectedMove->identifier), damage);
                     }
                 }
                 
-                if (!(attacker->is_confused >= 2)) {
-                    defender->hp -= damage;
-                } else if (attacker->is_confused >= 2) {
-                    attacker->hp -= damage;
+                if (!(hasStatus(attacker, STATUS_CONFUSED, 2))) {
+                    takeDamage(defender, damage);
+                } else if (hasStatus(attacker, STATUS_CONFUSED, 2)) {
+                    takeDamage(attacker, damage);
                 }
 
-                if (attacker->is_asleep >= 4) {
+                if (hasStatus(attacker, STATUS_ASLEEP, 4)) {
                     resetStatusEffects(attacker);
                     resetStatusEffects(defender);
-                } else if (defender->is_burned >= 4) {
+                } else if (hasStatus(defender, STATUS_BURNED, 4)) {
                     resetStatusEffects(attacker);
                     resetStatusEffects(defender);
-                } else if (attacker->is_confused >= 4) {
+                } else if (hasStatus(attacker, STATUS_CONFUSED, 4)) {
                     resetStatusEffects(attacker);
                     resetStatusEffects(defender);
-                } else if (attacker->is_frozen >= 4){
+                } else if (hasStatus(attacker, STATUS_FROZEN, 4)){
                     resetStatusEffects(attacker);
                     resetStatusEffects(defender);
-                } else if (attacker->is_paralyzed >= 4) {
+                } else if (hasStatus(attacker, STATUS_PARALYZED, 4)) {
                     resetStatusEffects(attacker);
                     resetStatusEffects(defender);
-                } else if (defender->is_poisoned >= 4) {
+                } else if (hasStatus(defender, STATUS_POISONED, 4)) {
                     resetStatusEffects(attacker);
                     resetStatusEffects(defender);
                 }
 
                 if (defender->hp <= 0) {
-                    mvprintw(currentLine++, 0, "%s is knocked out!", defender->pokemon.identifier.c_str());
+                    mvprintw(currentLine++, 0, "%s is knocked out!", name_of(defender->identifier));
                     defender->is_knocked_out = true;
                     int levelDiff = defender->level - attacker->level;
                     if (levelDiff <= 0){
@@ -2392,7 +4192,7 @@ void executeMove(PokemonWithMoves* attacker, PokemonWithMoves* defender, int mov
                     }
                 }
             } else {
-                mvprintw(currentLine++, 0, "%s's %s missed!", attacker->pokemon.identifier.c_str(), selectedMove->identifier.c_str());
+                mvprintw(currentLine++, 0, "%s's %s missed!", name_of(attacker->identifier), name_of(selectedMove->identifier));
             }
         } else {
             mvprintw(currentLine++, 0, "Invalid move selected.");
@@ -2406,51 +4206,52 @@ void executeMove(PokemonWithMoves* attacker, PokemonWithMoves* defender, int mov
     clear();
 }
 
-void fight(NPC* npc, int curPokeIndex, int curX, int curY) {
+void fight(NPCStore* npcs, int id, int curPokeIndex, int curX, int curY) {
+    Team team = npcs->team(id);
     clear();
     int currentLine = 0;
     int npcIndex = 0;
 
     // Check if the current Pokémon is knocked out and force a swap if so
     if (pcPokemons[curPokeIndex].is_knocked_out) {
-        mvprintw(currentLine++, 0, "Your %s is knocked out! You need to swap Pokemon.", pcPokemons[curPokeIndex].pokemon.identifier.c_str());
+        mvprintw(currentLine++, 0, "Your %s is knocked out! You need to swap Pokemon.", name_of(pcPokemons[curPokeIndex].identifier));
         showPokemonList();
         int pokeChoice = getch() - '0' - 1;
         if (pokeChoice >= 0 && static_cast<size_t>(pokeChoice) < pcPokemons.size() && !pcPokemons[pokeChoice].is_knocked_out && pokeChoice != curPokeIndex) {
             curPokeIndex = pokeChoice;
-            mvprintw(currentLine++, 0, "Switched to %s.", pcPokemons[curPokeIndex].pokemon.identifier.c_str());
+            mvprintw(currentLine++, 0, "Switched to %s.", name_of(pcPokemons[curPokeIndex].identifier));
         } else {
             mvprintw(currentLine++, 0, "Invalid selection.");
         }
         return;  // Early return to end the current fight function call
     }
 
-    mvprintw(currentLine++, 0, "Your %s (HP: %d/%d) is ready to fight!", pcPokemons[curPokeIndex].pokemon.identifier.c_str(), pcPokemons[curPokeIndex].hp, pcPokemons[curPokeIndex].max_hp);
+    mvprintw(currentLine++, 0, "Your %s (HP: %d/%d) is ready to fight!", name_of(pcPokemons[curPokeIndex].identifier), pcPokemons[curPokeIndex].hp, pcPokemons[curPokeIndex].max_hp);
     mvprintw(currentLine++, 0, "Select a move:");
-    for (size_t i = 0; i < pcPokemons[curPokeIndex].moves.size(); ++i) {
-        mvprintw(currentLine++, 0, "%d. %s", static_cast<int>(i + 1), pcPokemons[curPokeIndex].moves[i].c_str());
+    for (int i = 0; i < pcPokemons[curPokeIndex].numMoves; ++i) {
+        mvprintw(currentLine++, 0, "%d. %s", static_cast<int>(i + 1), move_name(pcPokemons[curPokeIndex].moves[i]));
     }
     mvprintw(currentLine++, 0, "Enter the number of your choice:");
     refresh();
 
     int moveChoice = getch() - '0' - 1;  // Adjust for correct index
-    if (moveChoice >= 0 && static_cast<size_t>(moveChoice) < static_cast<size_t>(pcPokemons[curPokeIndex].moves.size())) {
-        for (int i = 0; i < 6; i++){
-            if (npc->pokemons[i].is_knocked_out == false){
-                executeMove(&pcPokemons[curPokeIndex], &npc->pokemons[i], moveChoice);
+    if (moveChoice >= 0 && moveChoice < pcPokemons[curPokeIndex].numMoves) {
+        for (int i = 0; i < team.size(); i++){
+            if (team[i].is_knocked_out == false){
+                executeMove(&pcPokemons[curPokeIndex], &team[i], moveChoice);
                 // After player's move, check if the opponent got knocked out to avoid counter attack
-                if (!npc->pokemons[i].is_knocked_out) {
-                    executeMove(&npc->pokemons[i], &pcPokemons[curPokeIndex], rand() % 2); // Assuming NPC uses the first move
+                if (!team[i].is_knocked_out) {
+                    executeMove(&team[i], &pcPokemons[curPokeIndex], next_random(RNG_BATTLE) % 2); // Assuming NPC uses the first move
                 }
                 // Check if the player's Pokémon is knocked out after opponent's move
                 if (pcPokemons[curPokeIndex].is_knocked_out) {
-                    mvprintw(currentLine++, 0, "%s is knocked out! You need to swap Pokemon.", pcPokemons[curPokeIndex].pokemon.identifier.c_str());
+                    mvprintw(currentLine++, 0, "%s is knocked out! You need to swap Pokemon.", name_of(pcPokemons[curPokeIndex].identifier));
                     refresh();
                     showPokemonList();
                     int pokeChoice = getch() - '0' - 1;
                     if (pokeChoice >= 0 && static_cast<size_t>(pokeChoice) < pcPokemons.size() && !pcPokemons[pokeChoice].is_knocked_out && pokeChoice != curPokeIndex) {
                         curPokeIndex = pokeChoice;
-                        mvprintw(currentLine++, 0, "Switched to %s.", pcPokemons[curPokeIndex].pokemon.identifier.c_str());
+                        mvprintw(currentLine++, 0, "Switched to %s.", name_of(pcPokemons[curPokeIndex].identifier));
                     } else {
                         mvprintw(currentLine++, 0, "Invalid selection.");
                     }
@@ -2463,7 +4264,7 @@ void fight(NPC* npc, int curPokeIndex, int curX, int curY) {
     } else {
         mvprintw(currentLine++, 0, "Invalid move. Please try again.");
         getch();  // Pause to let user read the message
-        fight(npc, curPokeIndex, curX, curY);  // Retry selecting a move
+        fight(npcs, id, curPokeIndex, curX, curY);  // Retry selecting a move
     }
 
     // Implement logic to check if all player's Pokémon are knocked out
@@ -2477,10 +4278,10 @@ void fight(NPC* npc, int curPokeIndex, int curX, int curY) {
     }
     currentLine = 0;
     // After moves execution, update battle information
-    mvprintw(currentLine++, 0, "Your %s (HP: %d/%d)", pcPokemons[curPokeIndex].pokemon.identifier.c_str(), pcPokemons[curPokeIndex].hp, pcPokemons[curPokeIndex].max_hp);
-    mvprintw(currentLine++, 0, "Opponent's %s (HP: %d/%d)", npc->pokemons[npcIndex].pokemon.identifier.c_str(), npc->pokemons[npcIndex].hp, npc->pokemons[npcIndex].max_hp); // Assuming NPC has at least one Pokemon
+    mvprintw(currentLine++, 0, "Your %s (HP: %d/%d)", name_of(pcPokemons[curPokeIndex].identifier), pcPokemons[curPokeIndex].hp, pcPokemons[curPokeIndex].max_hp);
+    mvprintw(currentLine++, 0, "Opponent's %s (HP: %d/%d)", name_of(team[npcIndex].identifier), team[npcIndex].hp, team[npcIndex].max_hp); // Assuming NPC has at least one Pokemon
     refresh();
-    checkBattleOutcome(npc, currentLine);
+    checkBattleOutcome(npcs, id, currentLine);
     getch();  // Pause to view the outcome
     clear();
 }
@@ -2518,9 +4319,9 @@ void handleBagOption() {
                 mvprintw(currentLine++, 0, "Select a Pokemon to heal:");
                 int healChoice = getch() - '0' - 1;
                 if (healChoice >= 0 && static_cast<size_t>(healChoice) < pcPokemons.size() && pcPokemons[healChoice].hp > 0) {
-                    pcPokemons[healChoice].hp = std::min(pcPokemons[healChoice].max_hp, pcPokemons[healChoice].hp + 20);
+                    pcPokemons[healChoice].hp = std::min<int>(pcPokemons[healChoice].max_hp, pcPokemons[healChoice].hp + 20);
                     Potions--;
-                    mvprintw(currentLine++, 0, "Healed %s by 20 HP.", pcPokemons[healChoice].pokemon.identifier.c_str());
+                    mvprintw(currentLine++, 0, "Healed %s by 20 HP.", name_of(pcPokemons[healChoice].identifier));
                 } else {
                     mvprintw(currentLine++, 0, "Invalid choice or Pokemon is at full health.");
                 }
@@ -2537,7 +4338,7 @@ void handleBagOption() {
                     pcPokemons[reviveChoice].hp = pcPokemons[reviveChoice].max_hp / 2;
                     pcPokemons[reviveChoice].is_knocked_out = false;
                     Revives--;
-                    mvprintw(currentLine++, 0, "Revived %s.", pcPokemons[reviveChoice].pokemon.identifier.c_str());
+                    mvprintw(currentLine++, 0, "Revived %s.", name_of(pcPokemons[reviveChoice].identifier));
                 } else {
                     mvprintw(currentLine++, 0, "Invalid choice or Pokemon not knocked out.");
                 }
@@ -2547,54 +4348,60 @@ void handleBagOption() {
             break;
         case 4:  // Toxic Orbs
             if (ToxicOrb > 0) {
-                pcPokemons[curPokeIndex].is_poisoned = 1;
+                pcPokemons[curPokeIndex].status = STATUS_POISONED;
+                pcPokemons[curPokeIndex].statusTurns = 1;
                 ToxicOrb--;
-                mvprintw(currentLine++, 0, "%s is now holding a Toxic Orb.", pcPokemons[curPokeIndex].pokemon.identifier.c_str());
+                mvprintw(currentLine++, 0, "%s is now holding a Toxic Orb.", name_of(pcPokemons[curPokeIndex].identifier));
             } else {
                 mvprintw(currentLine++, 0, "No Toxic Orbs left!");
             }
             break;
         case 5:  // Light Balls
             if (LightBall > 0) {
-                pcPokemons[curPokeIndex].is_paralyzed = 1;
+                pcPokemons[curPokeIndex].status = STATUS_PARALYZED;
+                pcPokemons[curPokeIndex].statusTurns = 1;
                 LightBall--;
-                mvprintw(currentLine++, 0, "%s is now holding a Light Ball.", pcPokemons[curPokeIndex].pokemon.identifier.c_str());
+                mvprintw(currentLine++, 0, "%s is now holding a Light Ball.", name_of(pcPokemons[curPokeIndex].identifier));
             } else {
                 mvprintw(currentLine++, 0, "No Light Balls left!");
             }
             break;
         case 6:  // Flame Orbs
             if (FlameOrb > 0) {
-                pcPokemons[curPokeIndex].is_burned = 1;
+                pcPokemons[curPokeIndex].status = STATUS_BURNED;
+                pcPokemons[curPokeIndex].statusTurns = 1;
                 FlameOrb--;
-                mvprintw(currentLine++, 0, "%s is now holding a Flame Orb.", pcPokemons[curPokeIndex].pokemon.identifier.c_str());
+                mvprintw(currentLine++, 0, "%s is now holding a Flame Orb.", name_of(pcPokemons[curPokeIndex].identifier));
             } else {
                 mvprintw(currentLine++, 0, "No Flame Orbs left!");
             }
             break;
         case 7:  // Freeze Bombs
             if (FreezeBomb > 0) {
-                pcPokemons[curPokeIndex].is_frozen = 1;
+                pcPokemons[curPokeIndex].status = STATUS_FROZEN;
+                pcPokemons[curPokeIndex].statusTurns = 1;
                 FreezeBomb--;
-                mvprintw(currentLine++, 0, "%s is now holding a Freeze Bomb.", pcPokemons[curPokeIndex].pokemon.identifier.c_str());
+                mvprintw(currentLine++, 0, "%s is now holding a Freeze Bomb.", name_of(pcPokemons[curPokeIndex].identifier));
             } else {
                 mvprintw(currentLine++, 0, "No Freeze Bombs left!");
             }
             break;
         case 8:  // Sleep Powders
             if (SleepPowder > 0) {
-                pcPokemons[curPokeIndex].is_asleep = 1;
+                pcPokemons[curPokeIndex].status = STATUS_ASLEEP;
+                pcPokemons[curPokeIndex].statusTurns = 1;
                 SleepPowder--;
-                mvprintw(currentLine++, 0, "%s is now holding Sleep Powder.", pcPokemons[curPokeIndex].pokemon.identifier.c_str());
+                mvprintw(currentLine++, 0, "%s is now holding Sleep Powder.", name_of(pcPokemons[curPokeIndex].identifier));
             } else {
                 mvprintw(currentLine++, 0, "No Sleep Powders left!");
             }
             break;
         case 9:  // Sleep Powders
             if (ConfusionBomb > 0) {
-                pcPokemons[curPokeIndex].is_confused = 1;
+                pcPokemons[curPokeIndex].status = STATUS_CONFUSED;
+                pcPokemons[curPokeIndex].statusTurns = 1;
                 ConfusionBomb--;
-                mvprintw(currentLine++, 0, "%s is now holding Confusion Bomb.", pcPokemons[curPokeIndex].pokemon.identifier.c_str());
+                mvprintw(currentLine++, 0, "%s is now holding Confusion Bomb.", name_of(pcPokemons[curPokeIndex].identifier));
             } else {
                 mvprintw(currentLine++, 0, "No Confusion Bombs left!");
             }
@@ -2616,7 +4423,7 @@ bool tryToFlee(int trainerSpeed, int wildSpeed, int attempts) {
     if (wildSpeed == 0) return false;  // Prevent division by zero
 
     int oddsEscape = ((trainerSpeed * 32) / (wildSpeed / 4) % 256) + 30 * attempts;
-    if ((rand() % 256) < oddsEscape) {
+    if ((next_random(RNG_BATTLE) % 256) < oddsEscape) {
         return true;  // Successfully fled
     }
     return false;  // Failed to flee
@@ -2626,7 +4433,7 @@ void swapPokemon(int index) {
     clear();
     if (index >= 0 && static_cast<size_t>(index) < pcPokemons.size() && !pcPokemons[index].is_knocked_out) {
         curPokeIndex = index;  // Directly update curPokeIndex since tempIndex is not used
-        mvprintw(0, 0, "Switched to %s.", pcPokemons[curPokeIndex].pokemon.identifier.c_str());
+        mvprintw(0, 0, "Switched to %s.", name_of(pcPokemons[curPokeIndex].identifier));
     } else {
         mvprintw(0, 0, "Invalid choice or Pokemon is knocked out.");
     }
@@ -2636,21 +4443,22 @@ void swapPokemon(int index) {
 }
 
 
-void printNPCTrainerDetails(NPC* npc, int curX, int curY) {
+void printNPCTrainerDetails(NPCStore* npcs, int id, int curX, int curY) {
+    Team team = npcs->team(id);
     clear();
     int currentLine = 0;
     bool allKnockedOut = true;
 
-    if (npc->is_defeated) {
+    if (npcs->defeated[id]) {
         mvprintw(currentLine++, 0, "You have already defeated this trainer.");
     } else {
-        mvprintw(currentLine++, 0, "You are challenged by %c!", npc->type);
-        for (size_t i = 0; i < npc->pokemons.size(); ++i) {
-            mvprintw(currentLine++, 0, "Pokemon %d: %s (Level %d)", static_cast<int>(i + 1), npc->pokemons[i].pokemon.identifier.c_str(), npc->pokemons[i].level);
-            for (size_t j = 0; j < npc->pokemons[i].moves.size(); ++j) {
-                mvprintw(currentLine++, 4, "- %s", npc->pokemons[i].moves[j].c_str());
+        mvprintw(currentLine++, 0, "You are challenged by %c!", npcs->type[id]);
+        for (int i = 0; i < team.size(); ++i) {
+            mvprintw(currentLine++, 0, "Pokemon %d: %s (Level %d)", static_cast<int>(i + 1), name_of(team[i].identifier), team[i].level);
+            for (int j = 0; j < team[i].numMoves; ++j) {
+                mvprintw(currentLine++, 4, "- %s", move_name(team[i].moves[j]));
             }
-            if (!npc->pokemons[i].is_knocked_out) {
+            if (!team[i].is_knocked_out) {
                 allKnockedOut = false;
             }
         }
@@ -2693,7 +4501,7 @@ void printNPCTrainerDetails(NPC* npc, int curX, int curY) {
         int pokeChoice = 0;
         switch(key) {
             case '1':
-                fight(npc, curPokeIndex, curX, curY);
+                fight(npcs, id, curPokeIndex, curX, curY);
                 break;
             case '2':
                 handleBagOption();
@@ -2711,7 +4519,7 @@ void printNPCTrainerDetails(NPC* npc, int curX, int curY) {
                 pokeChoice = getch() - '0' - 1;
                 if (pokeChoice >= 0 && static_cast<size_t>(pokeChoice) < pcPokemons.size() && !pcPokemons[pokeChoice].is_knocked_out && pokeChoice != curPokeIndex) {
                     curPokeIndex = pokeChoice;
-                    mvprintw(currentLine++, 0, "Switched to %s.", pcPokemons[curPokeIndex].pokemon.identifier.c_str());
+                    mvprintw(currentLine++, 0, "Switched to %s.", name_of(pcPokemons[curPokeIndex].identifier));
                 } else {
                     mvprintw(currentLine++, 0, "Invalid selection.");
                 }
@@ -2732,50 +4540,75 @@ void printNPCTrainerDetails(NPC* npc, int curX, int curY) {
     }
 
     if (allKnockedOut) {
-        npc->is_defeated = true; // Mark the NPC as defeated only if all Pokémon are knocked out
+        npcs->defeated[id] = true; // Mark the NPC as defeated only if all Pokémon are knocked out
         mvprintw(currentLine++, 0, "Trainer is defeated. Press any key to continue.");
     } else {
         mvprintw(currentLine++, 0, "Fight is not over yet. Press any key to continue.");
-        printNPCTrainerDetails(npc, curX, curY);
+        printNPCTrainerDetails(npcs, id, curX, curY);
     }
 
     clear(); // Clear the screen after viewing the details
 }
 
+// Moves the PC one step by (dx, dy) on the map at world coordinates (curX, curY) if the cell is
+// walkable and free. Bumping into a trainer shows its details instead.
+void move_pc(map *m, int dx, int dy, int curX, int curY) {
+    int newX = m->pcX + dx;
+    int newY = m->pcY + dy;
+
+    if (is_occupied(m, newX, newY)) {
+        int id = trainer_at(m, newX, newY);
+        if (id != -1) {
+            printNPCTrainerDetails(&m->npcs, id, curX, curY);
+        }
+    } else if (m->board[newY][newX] != BORDER && m->board[newY][newX] != TREE && m->board[newY][newX] != WATER) {
+        place_pc(m, newX, newY);
+    }
+}
+
+// Moves the PC through a gate onto the neighboring map at world coordinates (mapX, mapY), generating it
+// on first visit, and puts the PC on cell (x, y) there.
+map *enter_through_gate(map *from, int mapX, int mapY, int preX, int preY, int numtrainers, int x, int y) {
+    remove_pc(from);
+    map *to = generateMap(mapX, mapY, preX, preY, numtrainers, 0);
+    place_pc(to, x, y);
+    return to;
+}
+
 void fightWildPokemon(PokemonWithMoves* pcPokemon, PokemonWithMoves* wildPokemon) {
     clear();
     int currentLine = 0;
 
     // Check if the current Pokémon is knocked out and force a swap if so
     if (pcPokemons[curPokeIndex].is_knocked_out) {
-        mvprintw(currentLine++, 0, "Your %s is knocked out! You need to swap Pokemon.", pcPokemons[curPokeIndex].pokemon.identifier.c_str());
+        mvprintw(currentLine++, 0, "Your %s is knocked out! You need to swap Pokemon.", name_of(pcPokemons[curPokeIndex].identifier));
         showPokemonList();
         int pokeChoice = getch() - '0' - 1;
         currentLine++;
         if (pokeChoice >= 0 && static_cast<size_t>(pokeChoice) < pcPokemons.size() && !pcPokemons[pokeChoice].is_knocked_out && pokeChoice != curPokeIndex) {
             curPokeIndex = pokeChoice;
-            mvprintw(currentLine++, 0, "Switched to %s.", pcPokemons[curPokeIndex].pokemon.identifier.c_str());
+            mvprintw(currentLine++, 0, "Switched to %s.", name_of(pcPokemons[curPokeIndex].identifier));
         } else {
             mvprintw(currentLine++, 0, "Invalid selection.");
         }
         return;  // Early return to end the current fight function call
     }
 
-    mvprintw(currentLine++, 0, "Starting fight with wild %s...", wildPokemon->pokemon.identifier.c_str());
+    mvprintw(currentLine++, 0, "Starting fight with wild %s...", name_of(wildPokemon->identifier));
     mvprintw(currentLine++, 0, "Select a move:");
-    for (size_t i = 0; i < pcPokemon->moves.size(); ++i) {
-        mvprintw(currentLine++, 0, "%d. %s", static_cast<int>(i + 1), pcPokemon->moves[i].c_str());
+    for (int i = 0; i < pcPokemon->numMoves; ++i) {
+        mvprintw(currentLine++, 0, "%d. %s", static_cast<int>(i + 1), move_name(pcPokemon->moves[i]));
     }
     refresh();
     
     int moveChoice = getch() - '0' - 1; // Adjust for index starting from 0
-    if (moveChoice >= 0 && moveChoice < static_cast<int>(pcPokemon->moves.size())) {
+    if (moveChoice >= 0 && moveChoice < pcPokemon->numMoves) {
         executeMove(pcPokemon, wildPokemon, moveChoice);
         if (!wildPokemon->is_knocked_out) {
-            executeMove(wildPokemon, pcPokemon, rand() % 2);
+            executeMove(wildPokemon, pcPokemon, next_random(RNG_BATTLE) % 2);
         }
         if (wildPokemon->hp <= 0) {
-            mvprintw(currentLine++, 0, "Wild %s fainted!", wildPokemon->pokemon.identifier.c_str());
+            mvprintw(currentLine++, 0, "Wild %s fainted!", name_of(wildPokemon->identifier));
         }
     } else if (getch() == 'q' || getch() == 'Q'){
         handleGameOver(pcPokemons);
@@ -2784,8 +4617,8 @@ void fightWildPokemon(PokemonWithMoves* pcPokemon, PokemonWithMoves* wildPokemon
     }
     currentLine = 0;
     // After moves execution, update battle information
-    mvprintw(currentLine++, 0, "Your %s (HP: %d/%d)", pcPokemons[curPokeIndex].pokemon.identifier.c_str(), pcPokemons[curPokeIndex].hp, pcPokemons[curPokeIndex].max_hp);
-    mvprintw(currentLine++, 0, "Opponent's %s (HP: %d/%d)", wildPokemon->pokemon.identifier.c_str(), wildPokemon->hp, wildPokemon->max_hp); // Assuming NPC has at least one Pokemon
+    mvprintw(currentLine++, 0, "Your %s (HP: %d/%d)", name_of(pcPokemons[curPokeIndex].identifier), pcPokemons[curPokeIndex].hp, pcPokemons[curPokeIndex].max_hp);
+    mvprintw(currentLine++, 0, "Opponent's %s (HP: %d/%d)", name_of(wildPokemon->identifier), wildPokemon->hp, wildPokemon->max_hp); // Assuming NPC has at least one Pokemon
     refresh();
 }
 
@@ -2830,7 +4663,7 @@ void wildPokemonEncounter(std::vector<PokemonWithMoves>& pcPokemons, int activeP
                 pokeChoice = getch() - '0' - 1;
                 if (pokeChoice >= 0 && static_cast<size_t>(pokeChoice) < pcPokemons.size() && !pcPokemons[pokeChoice].is_knocked_out && pokeChoice != curPokeIndex) {
                     curPokeIndex = pokeChoice;
-                    mvprintw(currentLine++, 0, "Switched to %s.", pcPokemons[curPokeIndex].pokemon.identifier.c_str());
+                    mvprintw(currentLine++, 0, "Switched to %s.", name_of(pcPokemons[curPokeIndex].identifier));
                 } else {
                     mvprintw(currentLine++, 0, "Invalid selection.");
                 }
@@ -2883,163 +4716,238 @@ void wildPokemonEncounter(std::vector<PokemonWithMoves>& pcPokemons, int activeP
     }
 }
 
-// Main function that initializes the game, processes user commands, and handles game logic.
-int main(int argc, char *argv[])
-{
-    if (argc == 2) {
-        std::string fileType = argv[1];
-        std::string filePath;
-
-        // Try to find the file in the first location
-        filePath = "/share/cs327/pokedex/pokedex/data/csv/" + fileType + ".csv";
-        if (!fileExists(filePath)) {
-            // If the file is not found, try the second location
-            const char* homeDir = getenv("HOME");
-            if (homeDir != nullptr) {
-                filePath = std::string(homeDir) + "/.poke327/pokedex/pokedex/data/csv/" + fileType + ".csv";
-                if (!fileExists(filePath)) {
-                    // If the file is still not found, try the third location
-                    filePath = "c:/cs327/pokedex/pokedex/data/csv/" + fileType + ".csv";
-                }
-            } else {
-                // If HOME environment variable isn't set, use the third location
-                filePath = "c:/cs327/pokedex/pokedex/data/csv/" + fileType + ".csv";
+// Seconds elapsed since start, used by the benchmarks.
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Picks a random interior cell the PC could stand on.
+void randomWalkableCell(map *terrain, int *x, int *y) {
+    do {
+        *x = next_random(RNG_BENCH) % (WIDTH - 2) + 1;
+        *y = next_random(RNG_BENCH) % (HEIGHT - 2) + 1;
+    } while (movement_costs(terrain, PC)[*y][*x] == SHRT_MAX);
+}
+
+// Times the distance-map kernel with one queue type on the benchmark maps, both rebuilding from scratch
+// and repairing after a one-cell PC step, and reports throughput as distance-map cells per second.
+template <class Queue>
+void benchmarkPathingWith(const char *label, int numMaps) {
+    const int runsPerMap = 200;
+    const double cellsPerRun = NUM_PATHING_TYPES * HEIGHT * WIDTH;
+    double fullSeconds = 0, repairSeconds = 0;
+    int fullRuns = 0, repairRuns = 0;
+
+    seed_random(2); // Same sources and walks for every queue type
+    for (int m = 0; m < numMaps; m++) {
+        map *terrain = get_map(m, 0);
+        DistanceMaps *maps = new DistanceMaps;
+        int x, y;
+
+        for (int r = 0; r < runsPerMap; r++) {
+            randomWalkableCell(terrain, &x, &y);
+            maps->srcX = -1; // Force a full rebuild
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            dijkstra_with_queue<Queue>(terrain, x, y, maps);
+            fullSeconds += secondsSince(start);
+            fullRuns++;
+        }
+
+        for (int r = 0; r < runsPerMap; r++) {
+            int nextX = x + next_random(RNG_BENCH) % 3 - 1;
+            int nextY = y + next_random(RNG_BENCH) % 3 - 1;
+            if ((nextX == x && nextY == y) || movement_costs(terrain, PC)[nextY][nextX] == SHRT_MAX) {
+                continue;
             }
+            x = nextX;
+            y = nextY;
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            dijkstra_with_queue<Queue>(terrain, x, y, maps);
+            repairSeconds += secondsSince(start);
+            repairRuns++;
         }
+        delete maps;
+    }
 
-        // At this point, filePath will either be the path to the found file, or the last location attempted
-        if (!fileExists(filePath)) {
-            // If the file is not found in any location, print an error message and exit
-            std::cerr << "Error: File not found in any of the specified locations." << std::endl;
-            return 1;
+    printf("  %s:\n", label);
+    printf("    full rebuild:    %8d runs, %8.1f us/run, %12.0f cells/sec\n", fullRuns,
+           1e6 * fullSeconds / fullRuns, cellsPerRun * fullRuns / fullSeconds);
+    printf("    one-step repair: %8d runs, %8.1f us/run, %12.0f cells/sec\n", repairRuns,
+           1e6 * repairSeconds / repairRuns, cellsPerRun * repairRuns / repairSeconds);
+}
+
+// Benchmarks the distance-map kernel on generated maps with each priority queue implementation.
+void benchmarkPathing() {
+    const int numMaps = 50;
+    for (int m = 0; m < numMaps; m++) {
+        generateMap(m, 0, MAP_CENTER, MAP_CENTER, 0, 0);
+    }
+
+    printf("pathing: %d pathing types, %d cells per map\n", NUM_PATHING_TYPES, HEIGHT * WIDTH);
+    benchmarkPathingWith<PriorityQueue>("binary heap", numMaps);
+    benchmarkPathingWith<QueueFor<TerrainCosts>::type>("bucket queue (TerrainCosts)", numMaps);
+}
+
+// Places up to count trainers of random types on free cells they can walk on, in random order, without
+// teams so the benchmark does not need the Pokedex. Returns how many fit.
+int scatterTrainers(map *m, int count) {
+    const char types[] = {HIKER, RIVAL, PACER, WANDERER, SENTRY, EXPLORER};
+    std::vector<int> cells;
+    for (int i = 1; i < HEIGHT - 1; i++) {
+        for (int j = 1; j < WIDTH - 1; j++) {
+            if (!is_occupied(m, j, i) && movement_costs(m, RIVAL)[i][j] != SHRT_MAX) {
+                cells.push_back(i * WIDTH + j);
+            }
+        }
+    }
+    for (int k = (int) cells.size() - 1; k > 0; k--) {
+        std::swap(cells[k], cells[next_random(RNG_BENCH) % (k + 1)]);
+    }
+
+    int placed = std::min(count, (int) cells.size());
+    m->npcs.reserve(m->npcs.size() + placed);
+    m->turns.heap.reserve(m->turns.heap.size() + placed);
+    for (int k = 0; k < placed; k++) {
+        int x = cells[k] % WIDTH, y = cells[k] / WIDTH;
+        int direction = next_random(RNG_BENCH) % 8;
+        char type = types[next_random(RNG_BENCH) % 6];
+        int id = m->npcs.add(x, y, type, npc_dx[direction], npc_dy[direction]);
+        if (type != SENTRY) {
+            schedule_turn(m, m->turns.now, id);
         }
+        m->occupant[y][x] = id;
+    }
+    return placed;
+}
 
-        if (fileType == "pokemon") {
-            std::vector<Pokemon> pokemons = parsePokemonCSV(filePath);
-            for (const auto& pokemon : pokemons) {
-                std::cout << "ID: " << (pokemon.id != INT_MAX ? std::to_string(pokemon.id) : "N/A")
-                        << ", Identifier: " << (!pokemon.identifier.empty() ? pokemon.identifier : "N/A")
-                        << ", Species ID: " << (pokemon.species_id != INT_MAX ? std::to_string(pokemon.species_id) : "N/A")
-                        << ", Height: " << (pokemon.height != INT_MAX ? std::to_string(pokemon.height) : "N/A")
-                        << ", Weight: " << (pokemon.weight != INT_MAX ? std::to_string(pokemon.weight) : "N/A")
-                        << ", Base Experience: " << (pokemon.base_experience != INT_MAX ? std::to_string(pokemon.base_experience) : "N/A")
-                        << ", Order: " << (pokemon.order != INT_MAX ? std::to_string(pokemon.order) : "N/A")
-                        << ", Is Default: " << (pokemon.is_default ? "Yes" : "No")
-                        << std::endl;
-            }
-        } else if (fileType == "moves") {
-            std::vector<Move> moves = parseMovesCSV(filePath);
-            for (const auto& move : moves) {
-                std::cout << "ID: " << (move.id != INT_MAX ? std::to_string(move.id) : "N/A")
-                        << ", Identifier: " << (!move.identifier.empty() ? move.identifier : "N/A")
-                        << ", Generation ID: " << (move.generation_id != INT_MAX ? std::to_string(move.generation_id) : "N/A")
-                        << ", Type ID: " << (move.type_id != INT_MAX ? std::to_string(move.type_id) : "N/A")
-                        << ", Power: " << (move.power != INT_MAX ? std::to_string(move.power) : "N/A")
-                        << ", PP: " << (move.pp != INT_MAX ? std::to_string(move.pp) : "N/A")
-                        << ", Accuracy: " << (move.accuracy != INT_MAX ? std::to_string(move.accuracy) : "N/A")
-                        << ", Priority: " << (move.priority != INT_MAX ? std::to_string(move.priority) : "N/A")
-                        << ", Target ID: " << (move.target_id != INT_MAX ? std::to_string(move.target_id) : "N/A")
-                        << ", Damage Class ID: " << (move.damage_class_id != INT_MAX ? std::to_string(move.damage_class_id) : "N/A")
-                        << ", Effect ID: " << (move.effect_id != INT_MAX ? std::to_string(move.effect_id) : "N/A")
-                        << ", Effect Chance: " << (move.effect_chance != INT_MAX ? std::to_string(move.effect_chance) : "N/A")
-                        << ", Contest Type ID: " << (move.contest_type_id != INT_MAX ? std::to_string(move.contest_type_id) : "N/A")
-                        << ", Contest Effect ID: " << (move.contest_effect_id != INT_MAX ? std::to_string(move.contest_effect_id) : "N/A")
-                        << ", Super Contest Effect ID: " << (move.super_contest_effect_id != INT_MAX ? std::to_string(move.super_contest_effect_id) : "N/A")
-                        << std::endl;
-            }
-        } else if (fileType == "pokemon_moves") {
-            std::vector<PokemonMove> pokemonMoves = parsePokemonMovesCSV(filePath);
-            for (const auto& pokemonMove : pokemonMoves) {
-                std::cout << "Pokemon ID: " << (pokemonMove.pokemon_id != INT_MAX ? std::to_string(pokemonMove.pokemon_id) : "N/A")
-                        << ", Version ID: " << (pokemonMove.version_id != INT_MAX ? std::to_string(pokemonMove.version_id) : "N/A")
-                        << ", Move ID: " << (pokemonMove.move_id != INT_MAX ? std::to_string(pokemonMove.move_id) : "N/A")
-                        << ", Pokemon Move Method ID: " << (pokemonMove.pokemon_move_method_id != INT_MAX ? std::to_string(pokemonMove.pokemon_move_method_id) : "N/A")
-                        << ", Level: " << (pokemonMove.level != INT_MAX ? std::to_string(pokemonMove.level) : "N/A")
-                        << ", Order: " << (pokemonMove.order != INT_MAX ? std::to_string(pokemonMove.order) : "N/A")
-                        << std::endl;
-            }
-        } else if (fileType == "pokemon_species") {
-            std::vector<PokemonSpecies> pokemonSpecies = parsePokemonSpeciesCSV(filePath);
-            for (const auto& species : pokemonSpecies) {
-                std::cout << "ID: " << (species.id != INT_MAX ? std::to_string(species.id) : "N/A")
-                        << ", Identifier: " << (!species.identifier.empty() ? species.identifier : "N/A")
-                        << ", Generation ID: " << (species.generation_id != INT_MAX ? std::to_string(species.generation_id) : "N/A")
-                        << ", Evolves From Species ID: " << (species.evolves_from_species_id != INT_MAX ? std::to_string(species.evolves_from_species_id) : "N/A")
-                        << ", Evolution Chain ID: " << (species.evolution_chain_id != INT_MAX ? std::to_string(species.evolution_chain_id) : "N/A")
-                        << ", Color ID: " << (species.color_id != INT_MAX ? std::to_string(species.color_id) : "N/A")
-                        << ", Shape ID: " << (species.shape_id != INT_MAX ? std::to_string(species.shape_id) : "N/A")
-                        << ", Habitat ID: " << (species.habitat_id != INT_MAX ? std::to_string(species.habitat_id) : "N/A")
-                        << ", Gender Rate: " << (species.gender_rate != INT_MAX ? std::to_string(species.gender_rate) : "N/A")
-                        << ", Capture Rate: " << (species.capture_rate != INT_MAX ? std::to_string(species.capture_rate) : "N/A")
-                        << ", Base Happiness: " << (species.base_happiness != INT_MAX ? std::to_string(species.base_happiness) : "N/A")
-                        << ", Is Baby: " << (species.is_baby ? "Yes" : "No")
-                        << ", Hatch Counter: " << (species.hatch_counter != INT_MAX ? std::to_string(species.hatch_counter) : "N/A")
-                        << ", Has Gender Differences: " << (species.has_gender_differences ? "Yes" : "No")
-                        << ", Growth Rate ID: " << (species.growth_rate_id != INT_MAX ? std::to_string(species.growth_rate_id) : "N/A")
-                        << ", Forms Switchable: " << (species.forms_switchable ? "Yes" : "No")
-                        << ", Is Legendary: " << (species.is_legendary ? "Yes" : "No")
-                        << ", Is Mythical: " << (species.is_mythical ? "Yes" : "No")
-                        << ", Order: " << (species.order != INT_MAX ? std::to_string(species.order) : "N/A")
-                        << ", Conquest Order: " << (species.conquest_order != INT_MAX ? std::to_string(species.conquest_order) : "N/A")
-                        << std::endl;
-            }
-        } else if (fileType == "experience") {
-            std::vector<Experience> experiences = parseExperienceCSV(filePath);
-            for (const auto& experience : experiences) {
-                std::cout << "Growth Rate ID: " << (experience.growth_rate_id != INT_MAX ? std::to_string(experience.growth_rate_id) : "N/A")
-                        << ", Level: " << (experience.level != INT_MAX ? std::to_string(experience.level) : "N/A")
-                        << ", Experience: " << (experience.experience != INT_MAX ? std::to_string(experience.experience) : "N/A")
-                        << std::endl;
-            }
-        } else if (fileType == "type_names") {
-            std::vector<TypeName> typeNames = parseTypeNamesCSV(filePath);
-            for (const auto& typeName : typeNames) {
-                if (typeName.local_language_id == 9) { // Check if it's English
-                    std::cout << "Type ID: " << (typeName.type_id != INT_MAX ? std::to_string(typeName.type_id) : "N/A")
-                            << ", Local Language ID: " << (typeName.local_language_id != INT_MAX ? std::to_string(typeName.local_language_id) : "N/A")
-                            << ", Name: " << (!typeName.name.empty() ? typeName.name : "N/A")
-                            << std::endl;
-                }
-            }
-        } else if (fileType == "pokemon_stats") {
-            std::vector<PokemonStat> pokemonStats = parsePokemonStatsCSV(filePath);
-            for (const auto& pokemonStat : pokemonStats) {
-                std::cout << "Pokemon ID: " << (pokemonStat.pokemon_id != INT_MAX ? std::to_string(pokemonStat.pokemon_id) : "N/A")
-                        << ", Stat ID: " << (pokemonStat.stat_id != INT_MAX ? std::to_string(pokemonStat.stat_id) : "N/A")
-                        << ", Base Stat: " << (pokemonStat.base_stat != INT_MAX ? std::to_string(pokemonStat.base_stat) : "N/A")
-                        << ", Effort: " << (pokemonStat.effort != INT_MAX ? std::to_string(pokemonStat.effort) : "N/A")
-                        << std::endl;
-            }
-        } else if (fileType == "stats") {
-            std::vector<Stat> stats = parseStatsCSV(filePath);
-            for (const auto& stat : stats) {
-                std::cout << "ID: " << (stat.id != INT_MAX ? std::to_string(stat.id) : "N/A") 
-                        << ", Damage Class ID: " << (stat.damage_class_id != INT_MAX ? std::to_string(stat.damage_class_id) : "N/A")
-                        << ", Identifier: " << (!stat.identifier.empty() ? stat.identifier : "N/A") 
-                        << ", Is Battle Only: " << (stat.is_battle_only ? "Yes" : "No") 
-                        << ", Game Index: " << (stat.game_index != INT_MAX ? std::to_string(stat.game_index) : "N/A") 
-                        << std::endl;
-            }
-        } else if (fileType == "pokemon_types") {
-            std::vector<PokemonType> pokemonTypes = parsePokemonTypesCSV(filePath);
-            for (const auto& pokemonType : pokemonTypes) {
-                std::cout << "Pokemon ID: " << (pokemonType.pokemon_id != INT_MAX ? std::to_string(pokemonType.pokemon_id) : "N/A")
-                        << ", Type ID: " << (pokemonType.type_id != INT_MAX ? std::to_string(pokemonType.type_id) : "N/A")
-                        << ", Slot: " << (pokemonType.slot != INT_MAX ? std::to_string(pokemonType.slot) : "N/A")
-                        << std::endl;
+// Times whole NPC turns (distance maps plus run_npc_turns) while the PC random-walks, for a growing
+// number of trainers on one map.
+void benchmarkNpcs() {
+    const int counts[] = {10, 100, 1000};
+    const int turns = 2000;
+
+    printf("npcs: %d turns per run\n", turns);
+    for (int c = 0; c < 3; c++) {
+        map *m = generateMap(c, 1, MAP_CENTER, MAP_CENTER, 0, 0);
+        int x, y;
+        randomWalkableCell(m, &x, &y);
+        place_pc(m, x, y);
+        int placed = scatterTrainers(m, counts[c]);
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (int t = 0; t < turns; t++) {
+            int nextX = m->pcX + next_random(RNG_BENCH) % 3 - 1;
+            int nextY = m->pcY + next_random(RNG_BENCH) % 3 - 1;
+            if (!is_occupied(m, nextX, nextY) && movement_costs(m, PC)[nextY][nextX] != SHRT_MAX) {
+                place_pc(m, nextX, nextY);
             }
-        } else {
-            std::cerr << "Error: Invalid file type specified." << std::endl;
-            return 1;
+            run_npc_turns(m, distance_maps(m, m->pcX, m->pcY));
+        }
+        double seconds = secondsSince(start);
+
+        printf("  %4d trainers requested, %4d placed: %10.0f turns/sec, %8.2f us/turn\n", counts[c], placed,
+               turns / seconds, 1e6 * seconds / turns);
+    }
+}
+
+// Returns the best time of a few runs of a loader, so the file cache is warm.
+double bestLoadTime(bool (*load)()) {
+    const int runs = 5;
+    double best = 0;
+    for (int r = 0; r < runs; r++) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        if (!load()) {
+            return -1;
+        }
+        double seconds = secondsSince(start);
+        if (r == 0 || seconds < best) {
+            best = seconds;
+        }
+    }
+    return best;
+}
+
+// Times loading the pokedex from the CSVs and, if one is current, from the snapshot.
+void benchmarkLoad() {
+    double csvSeconds = bestLoadTime([] { loadCsvData(); return true; });
+    size_t rows = allPokemons.size() + allMoves.size() + allPokemonMoves.size() + allPokemonSpecies.size() +
+                  allExperiences.size() + allTypeNames.size() + allPokemonStats.size() + allStats.size() +
+                  allPokemonTypes.size() + allPokemonHabitats.size();
+    printf("load: best of 5 runs, %zu rows (%zu in pokemon_moves), %d loader threads\n", rows,
+           allPokemonMoves.size(), loader_threads());
+    printf("  csv:      %8.1f ms, %10.0f rows/sec\n", 1e3 * csvSeconds, rows / csvSeconds);
+
+    double snapshotSeconds = bestLoadTime([] {
+        std::string snapshot = snapshotPath();
+        return !snapshot.empty() && loadSnapshot(snapshot.c_str());
+    });
+    if (snapshotSeconds < 0) {
+        printf("  snapshot: no current %s (run make snapshot)\n", SNAPSHOT_FILE);
+        loadCsvData();
+    } else {
+        printf("  snapshot: %8.1f ms, %10.0f rows/sec\n", 1e3 * snapshotSeconds, rows / snapshotSeconds);
+    }
+}
+
+// Runs the named benchmark ("all" runs every one) with a fixed seed so runs are comparable.
+int runBenchmarks(const std::string& which) {
+    seed_random(1);
+    bool ran = false;
+    if (which == "all" || which == "pathing") {
+        benchmarkPathing();
+        ran = true;
+    }
+    if (which == "all" || which == "npcs") {
+        benchmarkNpcs();
+        ran = true;
+    }
+    if (which == "all" || which == "load") {
+        benchmarkLoad();
+        ran = true;
+    }
+    if (!ran) {
+        std::cerr << "Error: Unknown benchmark '" << which << "'." << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+// Main function that initializes the game, processes user commands, and handles game logic.
+int main(int argc, char *argv[])
+{
+    if (argc >= 2 && strcmp(argv[1], "--bench") == 0) {
+        return runBenchmarks(argc > 2 ? argv[2] : "all");
+    }
+
+    if (argc >= 2 && strcmp(argv[1], "--build-snapshot") == 0) {
+        return buildSnapshot(argc > 2 ? argv[2] : NULL);
+    }
+
+    if (argc >= 3 && strcmp(argv[1], "--build-embedded") == 0) {
+        if (argc > 3) {
+            pokedexDir = argv[3];
         }
+        return buildEmbedded(argv[2]);
+    }
+
+    if (argc >= 3 && strcmp(argv[1], "query") == 0) {
+        return runQuery(argc - 2, argv + 2);
+    }
 
-        return 0; // Exit after parsing and printing the specified CSV file
+    // "Poke <table>" prints the whole table, the same as "Poke query <table>"
+    if (argc == 2 && argv[1][0] != '-') {
+        return runQuery(1, argv + 1);
     }
 
     loadData();
+    if (allPokemons.empty() || allMoves.empty() || allPokemonSpecies.empty()) {
+        std::cerr << "Error: Pokedex data not found. Put the pokedex CSVs in one of the locations listed in the README, or build with make embedded." << std::endl;
+        return 1;
+    }
 
     // If no CSV parsing argument is provided, proceed with the game initialization
     int numtrainers = 10; // Default value
+    uint64_t seed = time(NULL);
 
     // Parse command-line arguments
     for (int i = 1; i < argc; i++) {
@@ -3051,10 +4959,18 @@ int main(int argc, char *argv[])
                 fprintf(stderr, "Error: --numtrainers option requires an argument.\n");
                 return 1;
             }
+        } else if (strcmp(argv[i], "--seed") == 0) {
+            if (i + 1 < argc) {
+                seed = strtoull(argv[i + 1], NULL, 10);
+                i++;
+            } else {
+                fprintf(stderr, "Error: --seed option requires an argument.\n");
+                return 1;
+            }
         }
     }
 
-    srand(time(NULL));
+    seed_random(seed);
     int curX, curY, preX, preY;
     //char userInput;
 
@@ -3064,10 +4980,7 @@ int main(int argc, char *argv[])
     preX = curX;
     preY = curY;
 
-    int hikerDist[HEIGHT][WIDTH];
-    int rivalDist[HEIGHT][WIDTH];
-
-    generateMap(worldMap, curX, curY, preX, preY, numtrainers, 0);
+    map *cur = generateMap(curX, curY, preX, preY, numtrainers, 0);
 
     // Initialize ncurses
     initscr();
@@ -3080,53 +4993,8 @@ int main(int argc, char *argv[])
 
     chooseStartingPokemon();
 
-    // Allocate memory for the NPC array
-    NPC **npcs[MAP_SIZE][MAP_SIZE];
-    // Initialize NPC pointers to NULL
-    for (int i = 0; i < MAP_SIZE; i++) {
-        for (int j = 0; j < MAP_SIZE; j++) {
-            npcs[i][j] = NULL;
-        }
-    }
-
-    npcs[curY][curX] = new NPC*[numtrainers];
-    for (int i = 0; i < numtrainers; i++) {
-        npcs[curY][curX][i] = new NPC;
-    }
-    int npcIndex = 0;
-    for (int i = 0; i < HEIGHT; i++) {
-        for (int j = 0; j < WIDTH; j++) {
-            if (worldMap[curY][curX]->board[i][j] == HIKER || worldMap[curY][curX]->board[i][j] == RIVAL || worldMap[curY][curX]->board[i][j] == PACER || worldMap[curY][curX]->board[i][j] == WANDERER || worldMap[curY][curX]->board[i][j] == SENTRY || worldMap[curY][curX]->board[i][j] == EXPLORER) {
-                npcs[curY][curX][npcIndex]->x = j;
-                npcs[curY][curX][npcIndex]->y = i;
-                npcs[curY][curX][npcIndex]->cost = 0;
-                npcs[curY][curX][npcIndex]->type = worldMap[curY][curX]->board[i][j];
-
-                int habitatId = -1;  // Default value indicating no specific habitat is set
-                if (firstLayer[curY][curX]->board[i][j] == GRASS || firstLayer[curY][curX]->board[i][j] == TALL_GRASS) {
-                    habitatId = 3;  // Grassland
-                } else if (firstLayer[curY][curX]->board[i][j] == TREE) {
-                    habitatId = 2;  // Forest
-                }
-
-                npcs[curY][curX][npcIndex]->is_defeated = false;
-
-                // Generate Pokémon for this NPC
-                int numPokemons = 1 + (rand() % 6); // Each NPC has 1 to 6 Pokémon
-                for (int k = 0; k < numPokemons; k++) {
-                    // Generate a random Pokémon with moves
-                    
-                    PokemonWithMoves pokemon = generateRandomPokemonWithMoves(curX, curY, habitatId);
-                    npcs[curY][curX][npcIndex]->pokemons.push_back(pokemon);
-                }
-               
-                npcIndex++;
-            }
-        }
-    }
-
     clear();
-    displayMap(worldMap, curX, curY);
+    displayMap(cur);
     refresh();
     //printf("Logical Coordinates of the Current Map: (%d, %d)\n\n", curX - MAP_CENTER, curY - MAP_CENTER);
 
@@ -3136,32 +5004,13 @@ int main(int argc, char *argv[])
     // Main game loop
     while (!quit_game)
     {   
-        // Find the position of the PC on the map
-        int pcX = -1, pcY = -1;
-        for (int i = 0; i < HEIGHT; i++)
-        {
-            for (int j = 0; j < WIDTH; j++)
-            {
-                if (worldMap[curY][curX]->board[i][j] == PC)
-                {
-                    pcX = j;
-                    pcY = i;
-                    break;
-                }
-            }
-            if (pcX != -1) {
-                break;
-            }
-        }
+        assert(pc_position_consistent(cur));
 
-        dijkstra_with_priority_queue(worldMap[curY][curX], pcX, pcY, hikerDist, HIKER);
-        dijkstra_with_priority_queue(worldMap[curY][curX], pcX, pcY, rivalDist, RIVAL);
+        DistanceMaps *distances = distance_maps(cur, cur->pcX, cur->pcY);
 
-        for (int i = 0; i < numtrainers; i++) {
-            move_npc(npcs[curY][curX][i], worldMap, curX, curY, hikerDist, rivalDist);
-        }
+        run_npc_turns(cur, distances);
 
-        displayMap(worldMap, curX, curY);
+        displayMap(cur);
         refresh();
 
         // Get user input
@@ -3172,138 +5021,46 @@ int main(int argc, char *argv[])
             case '7':
             case 'y':
                 // Move up-left
-                worldMap[curY][curX]->board[pcY][pcX] = firstLayer[curY][curX]->board[pcY][pcX] ; // Replace the old position with first layer
-                if (worldMap[curY][curX]->board[pcY - 1][pcX - 1] != BORDER && worldMap[curY][curX]->board[pcY - 1][pcX - 1] != TREE && worldMap[curY][curX]->board[pcY - 1][pcX - 1] != WATER && worldMap[curY][curX]->board[pcY - 1][pcX - 1] != HIKER && worldMap[curY][curX]->board[pcY - 1][pcX - 1] != RIVAL && worldMap[curY][curX]->board[pcY - 1][pcX - 1] != EXPLORER && worldMap[curY][curX]->board[pcY - 1][pcX - 1] != WANDERER && worldMap[curY][curX]->board[pcY - 1][pcX - 1] != PACER && worldMap[curY][curX]->board[pcY - 1][pcX - 1] != SENTRY) {
-                    pcX -= 1;
-                    pcY -= 1;
-                } else if (worldMap[curY][curX]->board[pcY - 1][pcX - 1] == HIKER || worldMap[curY][curX]->board[pcY - 1][pcX - 1] == RIVAL || worldMap[curY][curX]->board[pcY - 1][pcX - 1] == EXPLORER || worldMap[curY][curX]->board[pcY - 1][pcX - 1] == WANDERER || worldMap[curY][curX]->board[pcY - 1][pcX - 1] == PACER || worldMap[curY][curX]->board[pcY - 1][pcX - 1] == SENTRY) {
-                    for (int i = 0; i < numtrainers; i++) {
-                        if (npcs[curY][curX][i]->x == pcX - 1 && npcs[curY][curX][i]->y == pcY - 1) {
-                            printNPCTrainerDetails(npcs[curY][curX][i], curX, curY);
-                            break;
-                        }
-                    }
-                }
-                worldMap[curY][curX]->board[pcY][pcX] = PC; // Place the PC at the new position
+                move_pc(cur, -1, -1, curX, curY);
                 break;
             case '8':
             case 'k':
                 // Move up
-                worldMap[curY][curX]->board[pcY][pcX] = firstLayer[curY][curX]->board[pcY][pcX] ; // Replace the old position with first layer
-                if (worldMap[curY][curX]->board[pcY - 1][pcX] != BORDER && worldMap[curY][curX]->board[pcY - 1][pcX] != TREE && worldMap[curY][curX]->board[pcY - 1][pcX] != WATER && worldMap[curY][curX]->board[pcY - 1][pcX] != HIKER && worldMap[curY][curX]->board[pcY - 1][pcX] != RIVAL && worldMap[curY][curX]->board[pcY - 1][pcX] != EXPLORER && worldMap[curY][curX]->board[pcY - 1][pcX] != WANDERER && worldMap[curY][curX]->board[pcY - 1][pcX] != PACER && worldMap[curY][curX]->board[pcY - 1][pcX] != SENTRY) {
-                    pcY -= 1;
-                } else if (worldMap[curY][curX]->board[pcY - 1][pcX] == HIKER || worldMap[curY][curX]->board[pcY - 1][pcX] == RIVAL || worldMap[curY][curX]->board[pcY - 1][pcX] == EXPLORER || worldMap[curY][curX]->board[pcY - 1][pcX] == WANDERER || worldMap[curY][curX]->board[pcY - 1][pcX] == PACER || worldMap[curY][curX]->board[pcY - 1][pcX] == SENTRY) {
-                    for (int i = 0; i < numtrainers; i++) {
-                        if (npcs[curY][curX][i]->x == pcX && npcs[curY][curX][i]->y == pcY - 1) {
-                            printNPCTrainerDetails(npcs[curY][curX][i], curX, curY);
-                            break;
-                        }
-                    }
-                }
-                worldMap[curY][curX]->board[pcY][pcX] = PC; // Place the PC at the new position
+                move_pc(cur, 0, -1, curX, curY);
                 break;
             case '9':
             case 'u':
                 // Move up-right
-                worldMap[curY][curX]->board[pcY][pcX] = firstLayer[curY][curX]->board[pcY][pcX] ; // Replace the old position with first layer
-                if (worldMap[curY][curX]->board[pcY - 1][pcX + 1] != BORDER && worldMap[curY][curX]->board[pcY - 1][pcX + 1] != TREE && worldMap[curY][curX]->board[pcY - 1][pcX + 1] != WATER && worldMap[curY][curX]->board[pcY - 1][pcX + 1] != HIKER && worldMap[curY][curX]->board[pcY - 1][pcX + 1] != RIVAL && worldMap[curY][curX]->board[pcY - 1][pcX + 1] != EXPLORER && worldMap[curY][curX]->board[pcY - 1][pcX +  1] != WANDERER && worldMap[curY][curX]->board[pcY - 1][pcX + 1] != PACER && worldMap[curY][curX]->board[pcY - 1][pcX + 1] != SENTRY) {
-                    pcX += 1;
-                    pcY -= 1;
-                } else if (worldMap[curY][curX]->board[pcY - 1][pcX + 1] == HIKER || worldMap[curY][curX]->board[pcY - 1][pcX + 1] == RIVAL || worldMap[curY][curX]->board[pcY - 1][pcX + 1] == EXPLORER || worldMap[curY][curX]->board[pcY - 1][pcX +  1] == WANDERER || worldMap[curY][curX]->board[pcY - 1][pcX + 1] == PACER || worldMap[curY][curX]->board[pcY - 1][pcX + 1] == SENTRY) {
-                    for (int i = 0; i < numtrainers; i++) {
-                        if (npcs[curY][curX][i]->x == pcX + 1 && npcs[curY][curX][i]->y == pcY - 1) {
-                            printNPCTrainerDetails(npcs[curY][curX][i], curX, curY);
-                            break;
-                        }
-                    }
-                }
-                worldMap[curY][curX]->board[pcY][pcX] = PC; // Place the PC at the new position
+                move_pc(cur, 1, -1, curX, curY);
                 break;
             case '6':
             case 'l':
                 // Move right
-                worldMap[curY][curX]->board[pcY][pcX] = firstLayer[curY][curX]->board[pcY][pcX] ; // Replace the old position with first layer
-                if (worldMap[curY][curX]->board[pcY][pcX + 1] != BORDER && worldMap[curY][curX]->board[pcY][pcX + 1] != TREE && worldMap[curY][curX]->board[pcY][pcX + 1] != WATER && worldMap[curY][curX]->board[pcY][pcX + 1] != HIKER && worldMap[curY][curX]->board[pcY][pcX + 1] != RIVAL && worldMap[curY][curX]->board[pcY][pcX + 1] != EXPLORER && worldMap[curY][curX]->board[pcY][pcX +  1] != WANDERER && worldMap[curY][curX]->board[pcY][pcX + 1] != PACER && worldMap[curY][curX]->board[pcY][pcX + 1] != SENTRY) {
-                    pcX += 1;
-                } else if (worldMap[curY][curX]->board[pcY][pcX + 1] == HIKER || worldMap[curY][curX]->board[pcY][pcX + 1] == RIVAL || worldMap[curY][curX]->board[pcY][pcX + 1] == EXPLORER || worldMap[curY][curX]->board[pcY][pcX +  1] == WANDERER || worldMap[curY][curX]->board[pcY][pcX + 1] == PACER || worldMap[curY][curX]->board[pcY][pcX + 1] == SENTRY) {
-                    for (int i = 0; i < numtrainers; i++) {
-                        if (npcs[curY][curX][i]->x == pcX + 1 && npcs[curY][curX][i]->y == pcY) {
-                            printNPCTrainerDetails(npcs[curY][curX][i], curX, curY);
-                            break;
-                        }
-                    }
-                }
-                worldMap[curY][curX]->board[pcY][pcX] = PC; // Place the PC at the new position
+                move_pc(cur, 1, 0, curX, curY);
                 break;
             case '3':
             case 'n':
                 // Move down-right
-                worldMap[curY][curX]->board[pcY][pcX] = firstLayer[curY][curX]->board[pcY][pcX] ; // Replace the old position with grass
-                if (worldMap[curY][curX]->board[pcY + 1][pcX + 1] != BORDER && worldMap[curY][curX]->board[pcY + 1][pcX + 1] != TREE && worldMap[curY][curX]->board[pcY + 1][pcX + 1] != WATER && worldMap[curY][curX]->board[pcY + 1][pcX + 1] != HIKER && worldMap[curY][curX]->board[pcY + 1][pcX + 1] != RIVAL && worldMap[curY][curX]->board[pcY + 1][pcX + 1] != EXPLORER && worldMap[curY][curX]->board[pcY + 1][pcX +  1] != WANDERER && worldMap[curY][curX]->board[pcY + 1][pcX + 1] != PACER && worldMap[curY][curX]->board[pcY + 1][pcX + 1] != SENTRY) {
-                    pcX += 1;
-                    pcY += 1;
-                } else if (worldMap[curY][curX]->board[pcY + 1][pcX + 1] == HIKER || worldMap[curY][curX]->board[pcY + 1][pcX + 1] == RIVAL || worldMap[curY][curX]->board[pcY + 1][pcX + 1] == EXPLORER || worldMap[curY][curX]->board[pcY + 1][pcX +  1] == WANDERER || worldMap[curY][curX]->board[pcY + 1][pcX + 1] == PACER || worldMap[curY][curX]->board[pcY + 1][pcX + 1] == SENTRY) {
-                    for (int i = 0; i < numtrainers; i++) {
-                        if (npcs[curY][curX][i]->x == pcX + 1 && npcs[curY][curX][i]->y == pcY + 1) {
-                            printNPCTrainerDetails(npcs[curY][curX][i], curX, curY);
-                            break;
-                        }
-                    }
-                }
-                worldMap[curY][curX]->board[pcY][pcX] = PC; // Place the PC at the new position
+                move_pc(cur, 1, 1, curX, curY);
                 break;
             case '2':
             case 'j':
                 // Move down
-                worldMap[curY][curX]->board[pcY][pcX] = firstLayer[curY][curX]->board[pcY][pcX] ; // Replace the old position with grass
-                if (worldMap[curY][curX]->board[pcY + 1][pcX] != BORDER && worldMap[curY][curX]->board[pcY + 1][pcX] != TREE && worldMap[curY][curX]->board[pcY + 1][pcX] != WATER && worldMap[curY][curX]->board[pcY + 1][pcX] != HIKER && worldMap[curY][curX]->board[pcY + 1][pcX] != RIVAL && worldMap[curY][curX]->board[pcY + 1][pcX] != EXPLORER && worldMap[curY][curX]->board[pcY + 1][pcX] != WANDERER && worldMap[curY][curX]->board[pcY + 1][pcX] != PACER && worldMap[curY][curX]->board[pcY + 1][pcX] != SENTRY) {
-                    pcY += 1;
-                } else if (worldMap[curY][curX]->board[pcY + 1][pcX] == HIKER || worldMap[curY][curX]->board[pcY + 1][pcX] == RIVAL || worldMap[curY][curX]->board[pcY + 1][pcX] == EXPLORER || worldMap[curY][curX]->board[pcY + 1][pcX] == WANDERER || worldMap[curY][curX]->board[pcY + 1][pcX] == PACER || worldMap[curY][curX]->board[pcY + 1][pcX] == SENTRY){
-                    for (int i = 0; i < numtrainers; i++) {
-                        if (npcs[curY][curX][i]->x == pcX && npcs[curY][curX][i]->y == pcY + 1) {
-                            printNPCTrainerDetails(npcs[curY][curX][i], curX, curY);
-                            break;
-                        }
-                    }
-                }
-                worldMap[curY][curX]->board[pcY][pcX] = PC; // Place the PC at the new position
+                move_pc(cur, 0, 1, curX, curY);
                 break;
             case '1':
             case 'b':
                 // Move down-left
-                worldMap[curY][curX]->board[pcY][pcX] = firstLayer[curY][curX]->board[pcY][pcX] ; // Replace the old position with grass
-                if (worldMap[curY][curX]->board[pcY + 1][pcX - 1] != BORDER && worldMap[curY][curX]->board[pcY + 1][pcX - 1] != TREE && worldMap[curY][curX]->board[pcY + 1][pcX - 1] != WATER && worldMap[curY][curX]->board[pcY + 1][pcX - 1] != HIKER && worldMap[curY][curX]->board[pcY + 1][pcX - 1] != RIVAL && worldMap[curY][curX]->board[pcY + 1][pcX - 1] != EXPLORER && worldMap[curY][curX]->board[pcY + 1][pcX - 1] != WANDERER && worldMap[curY][curX]->board[pcY + 1][pcX - 1] != PACER && worldMap[curY][curX]->board[pcY + 1][pcX - 1] != SENTRY) {
-                    pcX -= 1;
-                    pcY += 1;
-                } else if (worldMap[curY][curX]->board[pcY + 1][pcX - 1] == HIKER || worldMap[curY][curX]->board[pcY + 1][pcX - 1] == RIVAL || worldMap[curY][curX]->board[pcY + 1][pcX - 1] == EXPLORER || worldMap[curY][curX]->board[pcY + 1][pcX - 1] == WANDERER || worldMap[curY][curX]->board[pcY + 1][pcX - 1] == PACER || worldMap[curY][curX]->board[pcY + 1][pcX - 1] == SENTRY) {
-                    for (int i = 0; i < numtrainers; i++) {
-                        if (npcs[curY][curX][i]->x == pcX - 1 && npcs[curY][curX][i]->y == pcY + 1) {
-                            printNPCTrainerDetails(npcs[curY][curX][i], curX, curY);
-                            break;
-                        }
-                    }
-                }
-                worldMap[curY][curX]->board[pcY][pcX] = PC; // Place the PC at the new position
+                move_pc(cur, -1, 1, curX, curY);
                 break;
             case '4':
             case 'h':
                 // Move left
-                worldMap[curY][curX]->board[pcY][pcX] = firstLayer[curY][curX]->board[pcY][pcX] ; // Replace the old position with grass
-                if (worldMap[curY][curX]->board[pcY][pcX - 1] != BORDER && worldMap[curY][curX]->board[pcY][pcX - 1] != TREE && worldMap[curY][curX]->board[pcY][pcX - 1] != WATER && worldMap[curY][curX]->board[pcY][pcX - 1] != HIKER && worldMap[curY][curX]->board[pcY][pcX - 1] != RIVAL && worldMap[curY][curX]->board[pcY][pcX - 1] != EXPLORER && worldMap[curY][curX]->board[pcY][pcX - 1] != WANDERER && worldMap[curY][curX]->board[pcY][pcX - 1] != PACER && worldMap[curY][curX]->board[pcY][pcX - 1] != SENTRY) {
-                    pcX -= 1;
-                } else if (worldMap[curY][curX]->board[pcY][pcX - 1] == HIKER || worldMap[curY][curX]->board[pcY][pcX - 1] == RIVAL || worldMap[curY][curX]->board[pcY][pcX - 1] == EXPLORER || worldMap[curY][curX]->board[pcY][pcX - 1] == WANDERER || worldMap[curY][curX]->board[pcY][pcX - 1] == PACER || worldMap[curY][curX]->board[pcY][pcX - 1] == SENTRY) {
-                    for (int i = 0; i < numtrainers; i++) {
-                        if (npcs[curY][curX][i]->x == pcX - 1 && npcs[curY][curX][i]->y == pcY) {
-                            printNPCTrainerDetails(npcs[curY][curX][i], curX, curY);
-                            break;
-                        }
-                    }
-                }
-                worldMap[curY][curX]->board[pcY][pcX] = PC; // Place the PC at the new position
+                move_pc(cur, -1, 0, curX, curY);
                 break;
             case '>':
                 // Enter building
-                if (firstLayer[curY][curX]->board[pcY][pcX] == POKEMON_CENTER) {
+                if (cur->board[cur->pcY][cur->pcX] == POKEMON_CENTER) {
                     mvprintw(0, 0, "All your Pokemon have been healed. Press < to leave.");
                     for (auto& pokemon : pcPokemons) {
                         pokemon.hp = pokemon.max_hp;
@@ -3313,7 +5070,7 @@ int main(int argc, char *argv[])
                     do {
                         ch = getch();
                     } while (ch != '<');
-                } else if (firstLayer[curY][curX]->board[pcY][pcX] == POKEMART) {
+                } else if (cur->board[cur->pcY][cur->pcX] == POKEMART) {
                     mvprintw(0, 0, "Your items have been restocked. Press < to leave.");
                     Pokeballs = 3; // Number of Pokeballs available
                     Potions = 5;   // Number of Potions available
@@ -3364,7 +5121,7 @@ int main(int argc, char *argv[])
                         if (healChoice >= 0 && static_cast<size_t>(healChoice) < pcPokemons.size()) {
                             pcPokemons[healChoice].hp += 20;  // Heal 20 HP
                             Potions--;
-                            mvprintw(curLine++, 0, "Healed %s by 20 HP.", pcPokemons[healChoice].pokemon.identifier.c_str());
+                            mvprintw(curLine++, 0, "Healed %s by 20 HP.", name_of(pcPokemons[healChoice].identifier));
                         } else {
                             mvprintw(curLine++, 0, "Invalid selection. No Pokemon healed.");
                         }
@@ -3380,7 +5137,7 @@ int main(int argc, char *argv[])
                             pcPokemons[reviveChoice].hp = pcPokemons[reviveChoice].max_hp / 2;
                             pcPokemons[reviveChoice].is_knocked_out = false;
                             Revives--;
-                            mvprintw(curLine++, 0, "Revived %s.", pcPokemons[reviveChoice].pokemon.identifier.c_str());
+                            mvprintw(curLine++, 0, "Revived %s.", name_of(pcPokemons[reviveChoice].identifier));
                         } else {
                             mvprintw(curLine++, 0, "Invalid selection. No Pokemon revived.");
                         }
@@ -3401,16 +5158,16 @@ int main(int argc, char *argv[])
                 show_list = true;
                 while (show_list) {
                     clear();
-                    for (int i = list_offset; i < numtrainers; i++) {
+                    for (int i = list_offset; i < cur->npcs.size(); i++) {
                         // Calculate the relative position
-                        int relative_x = npcs[curY][curX][i]->x - pcX;
-                        int relative_y = npcs[curY][curX][i]->y - pcY;
+                        int relative_x = cur->npcs.x[i] - cur->pcX;
+                        int relative_y = cur->npcs.y[i] - cur->pcY;
                         // Determine the direction (north, south, east, west)
                         const char *ns = (relative_y > 0) ? "south" : "north";
                         const char *ew = (relative_x > 0) ? "east" : "west";
                         // Display the trainer info
                         mvprintw(i - list_offset, 0, "%c, %d %s and %d %s",
-                        npcs[curY][curX][i]->type, abs(relative_y), ns, abs(relative_x), ew);
+                        cur->npcs.type[i], abs(relative_y), ns, abs(relative_x), ew);
                     }
                     refresh();
 
@@ -3426,7 +5183,7 @@ int main(int argc, char *argv[])
                         case KEY_DOWN:
                         case 456:
                             // Scroll list down
-                            if (list_offset < numtrainers) {
+                            if (list_offset < cur->npcs.size()) {
                                 list_offset++;
                             }
                             break;
@@ -3453,7 +5210,7 @@ int main(int argc, char *argv[])
                     move(0, 0);
                     clrtoeol();
 
-                    worldMap[curY][curX]->board[pcY][pcX] = firstLayer[curY][curX]->board[pcY][pcX];
+                    remove_pc(cur);
 
                     // Update PC's current position to be within map bounds
                     preX = curX;
@@ -3463,39 +5220,7 @@ int main(int argc, char *argv[])
 
                     // Place PC at a valid location on the map
                     // Update NPCs and turn queues for the new map
-                    generateMap(worldMap, curX, curY, preX, preY, numtrainers, 1);
-                    if (npcs[curY][curX] == NULL) {
-                        npcs[curY][curX] = new NPC*[numtrainers];
-                        for (int i = 0; i < numtrainers; i++) {
-                            npcs[curY][curX][i] = new NPC;
-                        }
-                        int npcIndex = 0;
-                        for (int i = 0; i < HEIGHT; i++) {
-                            for (int j = 0; j < WIDTH; j++) {
-                                if (worldMap[curY][curX]->board[i][j] == HIKER || worldMap[curY][curX]->board[i][j] == RIVAL || worldMap[curY][curX]->board[i][j] == PACER || worldMap[curY][curX]->board[i][j] == WANDERER || worldMap[curY][curX]->board[i][j] == SENTRY || worldMap[curY][curX]->board[i][j] == EXPLORER) {
-                                    npcs[curY][curX][npcIndex]->x = j;
-                                    npcs[curY][curX][npcIndex]->y = i;
-                                    npcs[curY][curX][npcIndex]->cost = 0;
-                                    npcs[curY][curX][npcIndex]->type = worldMap[curY][curX]->board[i][j];
-                                    npcs[curY][curX][npcIndex]->is_defeated = false;
-                                    int habitatId = -1;  // Default value indicating no specific habitat is set
-                                    if (firstLayer[curY][curX]->board[i][j] == GRASS || firstLayer[curY][curX]->board[i][j] == TALL_GRASS) {
-                                        habitatId = 3;  // Grassland
-                                    } else if (firstLayer[curY][curX]->board[i][j] == TREE) {
-                                        habitatId = 2;  // Forest
-                                    }
-                                    // Generate Pokémon for this NPC
-                                    int numPokemons = 1 + (rand() % 6); // Each NPC has 1 to 6 Pokémon
-                                    for (int k = 0; k < numPokemons; k++) {
-                                        // Generate a random Pokémon with moves
-                                        PokemonWithMoves pokemon = generateRandomPokemonWithMoves(curX, curY, habitatId);
-                                        npcs[curY][curX][npcIndex]->pokemons.push_back(pokemon);
-                                    }
-                                    npcIndex++;
-                                }
-                            }
-                        }
-                    }
+                    cur = generateMap(curX, curY, preX, preY, numtrainers, 1);
                 }
                 break;
             case 'Q':
@@ -3509,244 +5234,89 @@ int main(int argc, char *argv[])
         
         // Refresh the screen to show any updates
         clear();
-        displayMap(worldMap, curX, curY);
+        displayMap(cur);
         refresh();
 
-        if (firstLayer[curY][curX]->board[pcY][pcX] == POKEMON_CENTER) {
+        if (cur->board[cur->pcY][cur->pcX] == POKEMON_CENTER) {
             mvprintw(0, 0, "You are on a Pokemon Center. Press > to enter.");
             refresh(); // Refresh the screen to show the message
-        } else if (firstLayer[curY][curX]->board[pcY][pcX] == POKEMART) {
+        } else if (cur->board[cur->pcY][cur->pcX] == POKEMART) {
             mvprintw(0, 0, "You are on a PokeMart. Press > to enter.");
             refresh(); // Refresh the screen to show the message
         }
 
-        if (pcX == 0) {
-            // Update the old position of the PC on the previous map
-            worldMap[curY][curX]->board[pcY][pcX] = firstLayer[curY][curX]->board[pcY][pcX];
+        if (cur->pcX == 0) {
             // West gate, move to the map on the left
             preY = curY;
             preX = curX;
             curX--;
-            pcX = WIDTH - 1; // Place the PC near the corresponding gate on the new map
-            generateMap(worldMap, curX, curY, preX, preY, numtrainers, 0);
-            if (npcs[curY][curX] == NULL) {
-                npcs[curY][curX] = new NPC*[numtrainers];
-                for (int i = 0; i < numtrainers; i++) {
-                    npcs[curY][curX][i] = new NPC;
-                }
-                
-                int npcIndex = 0;
-                for (int i = 0; i < HEIGHT; i++) {
-                    for (int j = 0; j < WIDTH; j++) {
-                        if (worldMap[curY][curX]->board[i][j] == HIKER || worldMap[curY][curX]->board[i][j] == RIVAL || worldMap[curY][curX]->board[i][j] == PACER || worldMap[curY][curX]->board[i][j] == WANDERER || worldMap[curY][curX]->board[i][j] == SENTRY || worldMap[curY][curX]->board[i][j] == EXPLORER) {
-                            npcs[curY][curX][npcIndex]->x = j;
-                            npcs[curY][curX][npcIndex]->y = i;
-                            npcs[curY][curX][npcIndex]->cost = 0;
-                            npcs[curY][curX][npcIndex]->type = worldMap[curY][curX]->board[i][j];
-                            npcs[curY][curX][npcIndex]->is_defeated = false;
-                            int habitatId = -1;  // Default value indicating no specific habitat is set
-                            if (firstLayer[curY][curX]->board[i][j] == GRASS || firstLayer[curY][curX]->board[i][j] == TALL_GRASS) {
-                                habitatId = 3;  // Grassland
-                            } else if (firstLayer[curY][curX]->board[i][j] == TREE) {
-                                habitatId = 2;  // Forest
-                            }
-                            // Generate Pokémon for this NPC
-                            int numPokemons = 1 + (rand() % 6); // Each NPC has 1 to 6 Pokémon
-                            for (int k = 0; k < numPokemons; k++) {
-                                // Generate a random Pokémon with moves
-                                PokemonWithMoves pokemon = generateRandomPokemonWithMoves(curX, curY, habitatId);
-                                npcs[curY][curX][npcIndex]->pokemons.push_back(pokemon);
-                            }
-                            npcIndex++;
-                        }
-                    }
-                }
-            }
-            // Place the PC in the new position on the new map
-            worldMap[curY][curX]->board[pcY][pcX] = PC;
-        } else if (pcX == WIDTH - 1) {
-            // Update the old position of the PC on the previous map
-            worldMap[curY][curX]->board[pcY][pcX] = firstLayer[curY][curX]->board[pcY][pcX];
+            cur = enter_through_gate(cur, curX, curY, preX, preY, numtrainers, WIDTH - 1, cur->pcY);
+        } else if (cur->pcX == WIDTH - 1) {
             // East gate, move to the map on the right
             preY = curY;
             preX = curX;
             curX++;
-            pcX = 0; // Place the PC near the corresponding gate on the new map
-            generateMap(worldMap, curX, curY, preX, preY, numtrainers, 0);
-            if (npcs[curY][curX] == NULL) {
-                npcs[curY][curX] = new NPC*[numtrainers];
-                for (int i = 0; i < numtrainers; i++) {
-                    npcs[curY][curX][i] = new NPC;
-                }
-                int npcIndex = 0;
-                for (int i = 0; i < HEIGHT; i++) {
-                    for (int j = 0; j < WIDTH; j++) {
-                        if (worldMap[curY][curX]->board[i][j] == HIKER || worldMap[curY][curX]->board[i][j] == RIVAL || worldMap[curY][curX]->board[i][j] == PACER || worldMap[curY][curX]->board[i][j] == WANDERER || worldMap[curY][curX]->board[i][j] == SENTRY || worldMap[curY][curX]->board[i][j] == EXPLORER) {
-                            npcs[curY][curX][npcIndex]->x = j;
-                            npcs[curY][curX][npcIndex]->y = i;
-                            npcs[curY][curX][npcIndex]->cost = 0;
-                            npcs[curY][curX][npcIndex]->type = worldMap[curY][curX]->board[i][j];
-                            npcs[curY][curX][npcIndex]->is_defeated = false;
-                            int habitatId = -1;  // Default value indicating no specific habitat is set
-                            if (firstLayer[curY][curX]->board[i][j] == GRASS || firstLayer[curY][curX]->board[i][j] == TALL_GRASS) {
-                                habitatId = 3;  // Grassland
-                            } else if (firstLayer[curY][curX]->board[i][j] == TREE) {
-                                habitatId = 2;  // Forest
-                            }
-                            // Generate Pokémon for this NPC
-                            int numPokemons = 1 + (rand() % 6); // Each NPC has 1 to 6 Pokémon
-                            for (int k = 0; k < numPokemons; k++) {
-                                // Generate a random Pokémon with moves
-                                PokemonWithMoves pokemon = generateRandomPokemonWithMoves(curX, curY, habitatId);
-                                npcs[curY][curX][npcIndex]->pokemons.push_back(pokemon);
-                            }
-                            npcIndex++;
-                        }
-                    }
-                }
-            }
-            // Place the PC in the new position on the new map
-            worldMap[curY][curX]->board[pcY][pcX] = PC;
-        } else if (pcY == 0) {
-            // Update the old position of the PC on the previous map
-            worldMap[curY][curX]->board[pcY][pcX] = firstLayer[curY][curX]->board[pcY][pcX];
+            cur = enter_through_gate(cur, curX, curY, preX, preY, numtrainers, 0, cur->pcY);
+        } else if (cur->pcY == 0) {
             // North gate, move to the map above
             preY = curY;
             preX = curX;
             curY--;
-            pcY = HEIGHT - 1; // Place the PC near the corresponding gate on the new map
-            generateMap(worldMap, curX, curY, preX, preY, numtrainers, 0);
-            if (npcs[curY][curX] == NULL) {
-                npcs[curY][curX] = new NPC*[numtrainers];
-                for (int i = 0; i < numtrainers; i++) {
-                    npcs[curY][curX][i] = new NPC;
-                }
-                int npcIndex = 0;
-                for (int i = 0; i < HEIGHT; i++) {
-                    for (int j = 0; j < WIDTH; j++) {
-                        if (worldMap[curY][curX]->board[i][j] == HIKER || worldMap[curY][curX]->board[i][j] == RIVAL || worldMap[curY][curX]->board[i][j] == PACER || worldMap[curY][curX]->board[i][j] == WANDERER || worldMap[curY][curX]->board[i][j] == SENTRY || worldMap[curY][curX]->board[i][j] == EXPLORER) {
-                            npcs[curY][curX][npcIndex]->x = j;
-                            npcs[curY][curX][npcIndex]->y = i;
-                            npcs[curY][curX][npcIndex]->cost = 0;
-                            npcs[curY][curX][npcIndex]->type = worldMap[curY][curX]->board[i][j];
-                            npcs[curY][curX][npcIndex]->is_defeated = false;
-                            int habitatId = -1;  // Default value indicating no specific habitat is set
-                            if (firstLayer[curY][curX]->board[i][j] == GRASS || firstLayer[curY][curX]->board[i][j] == TALL_GRASS) {
-                                habitatId = 3;  // Grassland
-                            } else if (firstLayer[curY][curX]->board[i][j] == TREE) {
-                                habitatId = 2;  // Forest
-                            }
-                            // Generate Pokémon for this NPC
-                            int numPokemons = 1 + (rand() % 6); // Each NPC has 1 to 6 Pokémon
-                            for (int k = 0; k < numPokemons; k++) {
-                                // Generate a random Pokémon with moves
-                                PokemonWithMoves pokemon = generateRandomPokemonWithMoves(curX, curY, habitatId);
-                                npcs[curY][curX][npcIndex]->pokemons.push_back(pokemon);
-                            }
-                            npcIndex++;
-                        }
-                    }
-                }
-            }
-            // Place the PC in the new position on the new map
-            worldMap[curY][curX]->board[pcY][pcX] = PC;
-        } else if (pcY == HEIGHT - 1) {
-            // Update the old position of the PC on the previous map
-            worldMap[curY][curX]->board[pcY][pcX] = firstLayer[curY][curX]->board[pcY][pcX];
+            cur = enter_through_gate(cur, curX, curY, preX, preY, numtrainers, cur->pcX, HEIGHT - 1);
+        } else if (cur->pcY == HEIGHT - 1) {
             // South gate, move to the map below
             preY = curY;
             preX = curX;
             curY++;
-            pcY = 0; // Place the PC near the corresponding gate on the new map
-            generateMap(worldMap, curX, curY, preX, preY, numtrainers, 0);
-            if (npcs[curY][curX] == NULL) {
-                npcs[curY][curX] = new NPC*[numtrainers];
-                for (int i = 0; i < numtrainers; i++) {
-                    npcs[curY][curX][i] = new NPC;
-                }
-                int npcIndex = 0;
-                for (int i = 0; i < HEIGHT; i++) {
-                    for (int j = 0; j < WIDTH; j++) {
-                        if (worldMap[curY][curX]->board[i][j] == HIKER || worldMap[curY][curX]->board[i][j] == RIVAL || worldMap[curY][curX]->board[i][j] == PACER || worldMap[curY][curX]->board[i][j] == WANDERER || worldMap[curY][curX]->board[i][j] == SENTRY || worldMap[curY][curX]->board[i][j] == EXPLORER) {
-                            npcs[curY][curX][npcIndex]->x = j;
-                            npcs[curY][curX][npcIndex]->y = i;
-                            npcs[curY][curX][npcIndex]->cost = 0;
-                            npcs[curY][curX][npcIndex]->type = worldMap[curY][curX]->board[i][j];
-                            npcs[curY][curX][npcIndex]->is_defeated = false;
-                            int habitatId = -1;  // Default value indicating no specific habitat is set
-                            if (firstLayer[curY][curX]->board[i][j] == GRASS || firstLayer[curY][curX]->board[i][j] == TALL_GRASS) {
-                                habitatId = 3;  // Grassland
-                            } else if (firstLayer[curY][curX]->board[i][j] == TREE) {
-                                habitatId = 2;  // Forest
-                            }
-                            // Generate Pokémon for this NPC
-                            int numPokemons = 1 + (rand() % 6); // Each NPC has 1 to 6 Pokémon
-                            for (int k = 0; k < numPokemons; k++) {
-                                // Generate a random Pokémon with moves
-                                PokemonWithMoves pokemon = generateRandomPokemonWithMoves(curX, curY, habitatId);
-                                npcs[curY][curX][npcIndex]->pokemons.push_back(pokemon);
-                            }
-                            npcIndex++;
-                        }
-                    }
-                }
-            }
-            // Place the PC in the new position on the new map
-            worldMap[curY][curX]->board[pcY][pcX] = PC;
+            cur = enter_through_gate(cur, curX, curY, preX, preY, numtrainers, cur->pcX, 0);
         }
 
-        if (firstLayer[curY][curX]->board[pcY][pcX] == TALL_GRASS) {
+        if (cur->board[cur->pcY][cur->pcX] == TALL_GRASS) {
             clear();
 
             // Determine if an encounter occurs (10% chance)
-            if (rand() % 10 == 0) {
+            if (next_random(RNG_ENCOUNTERS) % 10 == 0) {
                 if (currentWildPokemon != nullptr) {
-                    delete currentWildPokemon;
+                    release_pokemon(&transientPokemons, currentWildPokemon);
                     currentWildPokemon = nullptr;
                 }
 
-                // Create a new instance of PokemonWithMoves
-                currentWildPokemon = new PokemonWithMoves();
+                // Take a fresh PokemonWithMoves from the pool
+                currentWildPokemon = acquire_pokemon(&transientPokemons);
 
                 // Calculate the Manhattan distance from the center of the map
                 double man_distance = abs(curX - MAP_CENTER) + abs(curY - MAP_CENTER);
 
                 // Generate IVs for each stat
-                int IV_hp = rand() % 16;
-                int IV_attack = rand() % 16;
-                int IV_defense = rand() % 16;
-                int IV_special_attack = rand() % 16;
-                int IV_special_defense = rand() % 16;
-                int IV_speed = rand() % 16;
+                int IV_hp = next_random(RNG_POKEMON) % 16;
+                int IV_attack = next_random(RNG_POKEMON) % 16;
+                int IV_defense = next_random(RNG_POKEMON) % 16;
+                int IV_special_attack = next_random(RNG_POKEMON) % 16;
+                int IV_special_defense = next_random(RNG_POKEMON) % 16;
+                int IV_speed = next_random(RNG_POKEMON) % 16;
 
                 // Determine the level of the encountered Pokémon
                 int level;
                 if (man_distance <= 1) {
                     level = 1;
                 } else if (man_distance > 200) {
-                    level = (rand() % (int)((100 - ((man_distance - 200) / 2) + 1)) + ((man_distance - 200) / 2));
+                    level = (next_random(RNG_POKEMON) % (int)((100 - ((man_distance - 200) / 2) + 1)) + ((man_distance - 200) / 2));
                 } else {
-                    level = (rand() % (int)(man_distance / 2)) + 1;
+                    level = (next_random(RNG_POKEMON) % (int)(man_distance / 2)) + 1;
                 }
 
                 // Select a random Pokémon species
-                int random_species_index = rand() % allPokemonSpecies.size();
+                int random_species_index = next_random(RNG_POKEMON) % allPokemonSpecies.size();
                 int species_id = allPokemonSpecies[random_species_index].id;
 
                 // Find the base stats for the selected Pokémon species
-                int base_hp, base_attack, base_defense, base_special_attack, base_special_defense, base_speed;
-                for (const auto& stat : allPokemonStats) {
-                    if (stat.pokemon_id == species_id) {
-                        switch (stat.stat_id) {
-                            case 1: base_hp = stat.base_stat; break;
-                            case 2: base_attack = stat.base_stat; break;
-                            case 3: base_defense = stat.base_stat; break;
-                            case 4: base_special_attack = stat.base_stat; break;
-                            case 5: base_special_defense = stat.base_stat; break;
-                            case 6: base_speed = stat.base_stat; break;
-                        }
-                    }
-                }
+                const BaseStats& base = baseStatsOf(species_id);
+                int base_hp = base.stat[STAT_HP];
+                int base_attack = base.stat[STAT_ATTACK];
+                int base_defense = base.stat[STAT_DEFENSE];
+                int base_special_attack = base.stat[STAT_SPECIAL_ATTACK];
+                int base_special_defense = base.stat[STAT_SPECIAL_DEFENSE];
+                int base_speed = base.stat[STAT_SPEED];
 
                 // Calculate the actual stats
                 int hp = ((base_hp + IV_hp) * 2 * level) / 100 + level + 10;
@@ -3756,47 +5326,32 @@ int main(int argc, char *argv[])
                 int special_defense = ((base_special_defense + IV_special_defense) * 2 * level) / 100 + 5;
                 int speed = ((base_speed + IV_speed) * 2 * level) / 100 + 5;
 
-                // Determine the moves for the Pokémon based on its level and species
-                std::vector<int> move_ids;
-                for (const auto& pokemon_move : allPokemonMoves) {
-                    if (pokemon_move.pokemon_id == species_id && pokemon_move.level <= level) {
-                        move_ids.push_back(pokemon_move.move_id);
-                    }
-                }
-
-                // Ensure the Pokémon has at least one move
-                if (move_ids.empty()) {
-                    // Increase the level until the Pokémon has at least one move
-                    while (move_ids.empty() && level < 100) {
-                        level++;
-                        for (const auto& pokemon_move : allPokemonMoves) {
-                            if (pokemon_move.pokemon_id == species_id && pokemon_move.level <= level) {
-                                move_ids.push_back(pokemon_move.move_id);
-                            }
-                        }
-                    }
+                // Ensure the Pokémon has at least one move by raising its level to the first level it learns one
+                int firstLevel = firstLearnLevel(species_id);
+                if (firstLevel > level && level < 100) {
+                    level = std::min(firstLevel, 100);
                 }
 
-                // Select up to four moves randomly
-                std::vector<std::string> move_names;
-                for (int i = 0; i < 2 && i < static_cast<int>(move_ids.size()); ++i) {
-                    int move_id = move_ids[rand() % move_ids.size()];
-                    for (const auto& move : allMoves) {
-                        if (move.id == move_id) {
-                            move_names.push_back(move.identifier);
-                            break;
-                        }
+                // Determine the moves for the Pokémon based on its level and species
+                LearnsetSlice learnable = learnableMoves(species_id, level);
+                int numLearnable = learnable.end - learnable.begin;
+
+                // Select up to two moves randomly
+                for (int i = 0; i < 2 && i < numLearnable; ++i) {
+                    int row = learnable.begin + next_random(RNG_POKEMON) % numLearnable;
+                    if (pokedex.learnMoveRow[row] != -1) {
+                        add_move(currentWildPokemon, pokedex.learnMoveId[row]);
                     }
                 }
 
                 // Determine if the Pokémon is shiny
-                bool shiny = (rand() % 8192 == 0);
+                bool shiny = (next_random(RNG_POKEMON) % 8192 == 0);
 
                 // Determine the gender of the Pokémon
-                bool gender = (rand() % 2 == 0);
+                bool gender = (next_random(RNG_POKEMON) % 2 == 0);
 
                 // Display the encounter information
-                mvprintw(0, 0, "A wild %s appeared!", allPokemonSpecies[random_species_index].identifier.c_str());
+                mvprintw(0, 0, "A wild %s appeared!", name_of(allPokemonSpecies[random_species_index].identifier));
                 mvprintw(1, 0, "Level: %d", level);
                 mvprintw(2, 0, "HP: %d", hp);
                 mvprintw(3, 0, "Attack: %d", attack);
@@ -3806,13 +5361,15 @@ int main(int argc, char *argv[])
                 mvprintw(7, 0, "Speed: %d", speed);
                 mvprintw(8, 0, "Shiny: %s", shiny ? "Yes" : "No");
                 mvprintw(9, 0, "Gender: %s", gender ? "Female" : "Male");
-                for (size_t i = 0; i < move_names.size(); ++i) {
-                    mvprintw(10 + i, 0, "Move %d: %s", static_cast<int>(i + 1), move_names[i].c_str());
+                for (int i = 0; i < currentWildPokemon->numMoves; ++i) {
+                    mvprintw(10 + i, 0, "Move %d: %s", i + 1, move_name(currentWildPokemon->moves[i]));
                 }
 
                 refresh();
                 // Set up the new Pokémon's properties
-                currentWildPokemon->pokemon.identifier = allPokemonSpecies[random_species_index].identifier;
+                currentWildPokemon->identifier = allPokemonSpecies[random_species_index].identifier;
+                currentWildPokemon->species_id = species_id;
+                currentWildPokemon->pokemon_id = species_id; // A species' default form has the species' id
                 currentWildPokemon->level = level;
                 currentWildPokemon->hp = hp;
                 currentWildPokemon->max_hp = hp;  // Assuming max HP is set to the current HP initially
@@ -3820,24 +5377,14 @@ int main(int argc, char *argv[])
                 currentWildPokemon->attack = attack;
                 currentWildPokemon->defense = defense;
                 currentWildPokemon->speed = speed;
-                currentWildPokemon->is_asleep = 0;
-                currentWildPokemon->is_burned = 0;
-                currentWildPokemon->is_confused = 0;
-                currentWildPokemon->is_frozen = 0;
-                currentWildPokemon->is_paralyzed = 0;
-                currentWildPokemon->is_poisoned = 0;
+                currentWildPokemon->status = STATUS_NONE;
+                currentWildPokemon->statusTurns = 0;
                 currentWildPokemon->current_exp = 0;
-                currentWildPokemon->next_level_exp = experienceNeeded(currentWildPokemon->level, currentWildPokemon->pokemon.species_id);
-
-                // Assigning moves to the currentWildPokemon
-                currentWildPokemon->moves.clear();
-                for (const auto& move_name : move_names) {
-                    currentWildPokemon->moves.push_back(move_name);
-                }
+                currentWildPokemon->next_level_exp = experienceNeeded(currentWildPokemon->level, currentWildPokemon->species_id);
                 getch();
                 wildPokemonEncounter(pcPokemons, curPokeIndex, currentWildPokemon, attemps);
                 if (currentWildPokemon != nullptr) {
-                    delete currentWildPokemon;
+                    release_pokemon(&transientPokemons, currentWildPokemon);
                     currentWildPokemon = nullptr;
                 }
             }
@@ -3875,22 +5422,12 @@ int main(int argc, char *argv[])
     }
     
     // Free allocated memory for each map at the end of the program.
-    for (int i = 0; i < MAP_SIZE; i++) {
-        for (int j = 0; j < MAP_SIZE; j++) {
-            if (worldMap[i][j] != NULL && npcs[i][j] != NULL) { // Check if the NPC array was allocated
-                for (int k = 0; k < numtrainers; k++) {
-                    delete npcs[i][j][k];
-                }
-                delete[] npcs[i][j];
-            }
-            delete worldMap[i][j];
-            delete firstLayer[i][j];
-        }
-    }
+    free_world();
 
     // Clean up ncurses and exit
     mvprintw(0, 0, "Leaving the Game...");
     refresh(); // Refresh the screen to show the message
     endwin();
+    printf("Seed: %llu\n", (unsigned long long) randomSeed); // Replay this game with --seed
     return 0;
 }
\ No newline at end of file